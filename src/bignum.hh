@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+//  sign-magnitude fixed-point number, limb 0 holds the integer part and
+//  every further limb 32 more fractional bits
+class Bignum {
+ public:
+  using Limb = std::uint32_t;
+  static constexpr int LIMB_BITS = 32;
+
+  //  columns computed below the last kept limb so that truncated products
+  //  are still exact to within a few units of it
+  static constexpr int GUARD_LIMBS = 2;
+
+  explicit Bignum(const int& limbs = 2) : limbs_(std::max(limbs, 1), 0) {}
+
+  Bignum(const long double& value, const int& limbs) : Bignum(limbs) {
+    negative_ = value < 0;
+    long double rest = std::abs(value);
+    for (auto& limb : limbs_) {
+      //  exact, as scaling by 2^32 and dropping the integer part never rounds
+      limb = static_cast<Limb>(rest);
+      rest = std::ldexp(rest - limb, LIMB_BITS);
+    }
+  }
+
+  //  from raw limbs, most significant first, as read back from limb()
+  Bignum(std::vector<Limb> limbs, const bool& negative)
+      : negative_(negative), limbs_(std::move(limbs)) {
+    if (limbs_.empty()) limbs_.assign(1, 0);
+  }
+
+  //  parses "[-]digits[.digits]", limbs = 0 keeps every given digit
+  explicit Bignum(const std::string& decimal, int limbs = 0) {
+    std::size_t i = 0;
+    while (i < decimal.size() && std::isspace(decimal[i])) ++i;
+    negative_ = i < decimal.size() && decimal[i] == '-';
+    if (i < decimal.size() && (decimal[i] == '-' || decimal[i] == '+')) ++i;
+
+    Limb integer = 0;
+    for (; i < decimal.size() && std::isdigit(decimal[i]); ++i)
+      integer = integer * 10 + (decimal[i] - '0');
+
+    std::string fraction;
+    if (i < decimal.size() && decimal[i] == '.')
+      for (++i; i < decimal.size() && std::isdigit(decimal[i]); ++i)
+        fraction += decimal[i];
+
+    //  log2(10) < 3.33 bits per digit
+    if (limbs <= 0) limbs = 2 + fraction.size() * 10 / 3 / LIMB_BITS;
+    limbs_.assign(limbs, 0);
+    limbs_[0] = integer;
+
+    //  the fraction as base 10^9 chunks, most significant first, every
+    //  multiplication by 2^32 carries the next binary limb out of the top
+    constexpr std::uint64_t CHUNK = 1000000000;
+    fraction.append((9 - fraction.size() % 9) % 9, '0');
+    std::vector<std::uint64_t> chunks;
+    for (std::size_t k{}; k < fraction.size(); k += 9)
+      chunks.push_back(std::stoull(fraction.substr(k, 9)));
+
+    for (std::size_t l = 1; l < limbs_.size(); ++l) {
+      std::uint64_t carry = 0;
+      for (std::size_t k = chunks.size(); k-- > 0;) {
+        const std::uint64_t t = (chunks[k] << LIMB_BITS) + carry;
+        chunks[k] = t % CHUNK;
+        carry = t / CHUNK;
+      }
+      limbs_[l] = static_cast<Limb>(carry);
+    }
+  }
+
+  int limbs() const { return limbs_.size(); }
+  Limb limb(const int& i) const { return i < limbs() ? limbs_[i] : 0; }
+  bool negative() const { return negative_ && !zero(); }
+
+  bool zero() const {
+    return std::all_of(limbs_.begin(), limbs_.end(),
+                       [](const Limb& limb) { return limb == 0; });
+  }
+
+  //  widens with zero limbs or truncates to the given precision
+  void set_limbs(const int& limbs) { limbs_.resize(std::max(limbs, 1), 0); }
+
+  //  rounds to the nearest representable long double, the fractional part of
+  //  a tiny value is located first so no relative precision is lost
+  explicit operator long double() const { return convert<long double>(3); }
+
+  explicit operator double() const {
+    return static_cast<double>(static_cast<long double>(*this));
+  }
+
+  explicit operator __float128() const { return convert<__float128>(5); }
+
+  Bignum operator-() const {
+    Bignum result = *this;
+    result.negative_ = !negative_;
+    return result;
+  }
+
+  friend Bignum operator+(const Bignum& a, const Bignum& b) {
+    if (a.negative_ == b.negative_) return signed_sum(a, b, a.negative_);
+    return signed_difference(a, b);
+  }
+
+  friend Bignum operator-(const Bignum& a, const Bignum& b) { return a + -b; }
+
+  //  truncated product at the larger of the two precisions
+  friend Bignum operator*(const Bignum& a, const Bignum& b) {
+    const int n = std::max(a.limbs(), b.limbs());
+    Bignum result(n);
+    result.negative_ = a.negative_ != b.negative_;
+
+    //  column c collects every x_i y_j with i + j = c, columns below the
+    //  guard limbs only ever carry into the last kept limb and are skipped
+    unsigned __int128 carry = 0;
+    for (int c = n - 1 + GUARD_LIMBS; c >= 0; --c) {
+      unsigned __int128 column = carry;
+      for (int i = std::max(0, c - n + 1); i <= std::min(c, n - 1); ++i)
+        column += static_cast<std::uint64_t>(a.limb(i)) * b.limb(c - i);
+      if (c < n) result.limbs_[c] = static_cast<Limb>(column);
+      carry = column >> LIMB_BITS;
+    }
+    return result;
+  }
+
+  //  the Mandelbrot recurrence is dominated by squares, which need only
+  //  half of the limb products since x_i x_j = x_j x_i
+  friend Bignum squared(const Bignum& x) {
+    const int n = x.limbs();
+    Bignum result(n);
+
+    unsigned __int128 carry = 0;
+    for (int c = n - 1 + GUARD_LIMBS; c >= 0; --c) {
+      const unsigned __int128 column = carry + square_column(x, c);
+      if (c < n) result.limbs_[c] = static_cast<Limb>(column);
+      carry = column >> LIMB_BITS;
+    }
+    return result;
+  }
+
+  //  the square split up for threads: every column sum of the n +
+  //  GUARD_LIMBS columns is independent of the others, so disjoint ranges
+  //  of them can be summed concurrently, and only the carries between them
+  //  are resolved in order afterwards
+  static void square_columns(const Bignum& x, const int& begin, const int& end,
+                             unsigned __int128* columns) {
+    for (int c = begin; c < end; ++c) columns[c] = square_column(x, c);
+  }
+
+  //  the truncated square of an n limb number from its column sums
+  static Bignum from_square_columns(const unsigned __int128* columns,
+                                    const int& n) {
+    Bignum result(n);
+    unsigned __int128 carry = 0;
+    for (int c = n - 1 + GUARD_LIMBS; c >= 0; --c) {
+      const unsigned __int128 column = carry + columns[c];
+      if (c < n) result.limbs_[c] = static_cast<Limb>(column);
+      carry = column >> LIMB_BITS;
+    }
+    return result;
+  }
+
+  //  equal in value, whatever the precision either is held at
+  friend bool operator==(const Bignum& a, const Bignum& b) {
+    return a.negative() == b.negative() && compare_magnitude(a, b) == 0;
+  }
+
+  Bignum& operator+=(const Bignum& other) { return *this = *this + other; }
+  Bignum& operator-=(const Bignum& other) { return *this = *this - other; }
+  Bignum& operator*=(const Bignum& other) { return *this = *this * other; }
+
+ private:
+  template <typename T>
+  T convert(const std::size_t& significant_limbs) const {
+    std::size_t first = 0;
+    while (first < limbs_.size() && limbs_[first] == 0) ++first;
+
+    T value = 0;
+    for (std::size_t i = std::min(first + significant_limbs, limbs_.size());
+         i-- > first;) {
+      //  exact power of two scaling without ldexp, which __float128 lacks
+      T weight = 1;
+      for (std::size_t k{}; k < i; ++k) weight /= T(4294967296.0L);
+      value += T(limbs_[i]) * weight;
+    }
+    return negative_ ? -value : value;
+  }
+
+  //  sum of x_i x_j over i + j = c, without the carry from below
+  static unsigned __int128 square_column(const Bignum& x, const int& c) {
+    const int n = x.limbs();
+    unsigned __int128 cross = 0;
+    const int first = std::max(0, c - n + 1);
+    for (int i = first; i < c - i; ++i)
+      cross += static_cast<std::uint64_t>(x.limb(i)) * x.limb(c - i);
+
+    unsigned __int128 column = cross << 1;
+    if (c % 2 == 0 && c / 2 < n)
+      column += static_cast<std::uint64_t>(x.limb(c / 2)) * x.limb(c / 2);
+    return column;
+  }
+
+  static int compare_magnitude(const Bignum& x, const Bignum& y) {
+    for (int i{}; i < std::max(x.limbs(), y.limbs()); ++i)
+      if (x.limb(i) != y.limb(i)) return x.limb(i) < y.limb(i) ? -1 : 1;
+    return 0;
+  }
+
+  static Bignum signed_sum(const Bignum& a, const Bignum& b,
+                           const bool& negative) {
+    const int n = std::max(a.limbs(), b.limbs());
+
+    Bignum result(n);
+    std::uint64_t carry = 0;
+    for (int i = n; i-- > 0;) {
+      const std::uint64_t t =
+          static_cast<std::uint64_t>(a.limb(i)) + b.limb(i) + carry;
+      result.limbs_[i] = static_cast<Limb>(t);
+      carry = t >> LIMB_BITS;
+    }
+    result.negative_ = negative;
+    return result;
+  }
+
+  //  a + b for operands of opposite sign
+  static Bignum signed_difference(const Bignum& a, const Bignum& b) {
+    const bool swap = compare_magnitude(a, b) < 0;
+    const Bignum& x = swap ? b : a;
+    const Bignum& y = swap ? a : b;
+    const int n = std::max(a.limbs(), b.limbs());
+
+    Bignum result(n);
+    std::int64_t borrow = 0;
+    for (int i = n; i-- > 0;) {
+      std::int64_t t =
+          static_cast<std::int64_t>(x.limb(i)) - y.limb(i) - borrow;
+      borrow = t < 0;
+      if (borrow) t += std::int64_t(1) << LIMB_BITS;
+      result.limbs_[i] = static_cast<Limb>(t);
+    }
+    result.negative_ = x.negative_;
+    return result;
+  }
+
+  bool negative_ = false;
+  std::vector<Limb> limbs_;
+};
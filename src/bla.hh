@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "formula.hh"
+#include "reference_orbit.hh"
+
+//  relative size of the dropped dz^2 term a linear step may tolerate
+constexpr double BLA_EPSILON = 1.0 / (1ull << 40);
+
+//  dz_{n+l} = A dz_n + B dc, valid while |dz_n| < radius
+struct Bla {
+  std::complex<double> a, b;
+  double radius;
+};
+
+//  bivariate linear approximations of the perturbed recurrence, level k
+//  holds the merged steps over [1 + j 2^k, 1 + (j + 1) 2^k) so a pixel can
+//  skip up to a power of two of iterations from any aligned position
+class BlaTable {
+ public:
+  BlaTable() = default;
+
+  //  dc_max bounds |dc| over every pixel the table is used for, in long
+  //  double so it still counts on frames past the range of a double
+  BlaTable(const ReferenceOrbit& orbit, const long double& dc_max) {
+    const int last = orbit.size() - 1;
+    if (last < 2) return;
+
+    //  single steps: A = 2 Z_n, B = 1, valid while dz^2 is negligible
+    std::vector<Bla> level;
+    for (int n = 1; n < last; ++n) {
+      const std::complex<double> z(orbit.re(n), orbit.im(n));
+      level.push_back({2.0 * z, 1.0, BLA_EPSILON * std::abs(z)});
+    }
+
+    while (level.size() > 1) {
+      std::vector<Bla> merged;
+      for (std::size_t j{}; j + 1 < level.size(); j += 2) {
+        const Bla& x = level[j];
+        const Bla& y = level[j + 1];
+        const double radius = std::min(
+            x.radius,
+            std::max(0.0, static_cast<double>(
+                              (y.radius - std::abs(x.b) * dc_max) /
+                              std::abs(x.a))));
+        merged.push_back({y.a * x.a, y.a * x.b + y.b, radius});
+      }
+      levels_.push_back(std::move(merged));
+      level = levels_.back();
+    }
+  }
+
+  //  longest approximation starting at iteration n that covers no more than
+  //  `limit` iterations and is valid for |dz|^2 = dz_norm, nullptr otherwise
+  //  the norm is compared in the delta type D, a FloatExp norm far below
+  //  the range of a double would flush to 0 there and pass every radius
+  template <typename D>
+  const Bla* lookup(const int& n, const D& dz_norm, const int& limit,
+                    int& length) const {
+    if (n < 1) return nullptr;
+
+    //  merging only ever shrinks the radius, so the levels are walked
+    //  upwards from two-step blocks until the first one that does not fit,
+    //  single steps are no cheaper than a regular perturbed step and are not
+    //  stored
+    const int aligned = n == 1 ? levels_.size() : __builtin_ctz(n - 1);
+    const Bla* best = nullptr;
+    for (int k{}; k < std::min<int>(aligned, levels_.size()); ++k) {
+      const int step = 2 << k;
+      const std::size_t j = (n - 1) >> (k + 1);
+      if (step > limit || j >= levels_[k].size()) break;
+
+      const Bla& bla = levels_[k][j];
+      if (!(dz_norm < squared(D(bla.radius)))) break;
+      best = &bla, length = step;
+    }
+    return best;
+  }
+
+ private:
+  std::vector<std::vector<Bla>> levels_;
+};
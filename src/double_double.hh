@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cmath>
+
+#include "bignum.hh"
+
+//  unevaluated sum hi + lo of two doubles with |lo| <= ulp(hi) / 2, about
+//  106 bits of mantissa out of a handful of plain double operations, so
+//  unlike long double or quad it maps onto the vector units
+//  the error-free transformations below are exact as long as FMA is and no
+//  intermediate overflows, which holds for every orbit that has not escaped
+class DoubleDouble {
+ public:
+  DoubleDouble() = default;
+
+  DoubleDouble(const int& value) : hi_(value) {}
+
+  DoubleDouble(const double& value) : hi_(value) {}
+
+  DoubleDouble(const long double& value)
+      : hi_(static_cast<double>(value)),
+        lo_(static_cast<double>(value - hi_)) {}
+
+  DoubleDouble(const __float128& value)
+      : hi_(static_cast<double>(value)),
+        lo_(static_cast<double>(value - hi_)) {}
+
+  //  the leading 106 bits of the number, quad keeps 113 of them
+  explicit DoubleDouble(const Bignum& value)
+      : DoubleDouble(static_cast<__float128>(value)) {}
+
+  double hi() const { return hi_; }
+  double lo() const { return lo_; }
+
+  explicit operator double() const { return hi_ + lo_; }
+
+  explicit operator long double() const {
+    return static_cast<long double>(hi_) + lo_;
+  }
+
+  DoubleDouble operator-() const { return {-hi_, -lo_}; }
+
+  //  the sum with both error terms folded back in
+  friend DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b) {
+    double e, f;
+    const double s = two_sum(a.hi_, b.hi_, e);
+    const double t = two_sum(a.lo_, b.lo_, f);
+    e += t;
+    const double u = quick_two_sum(s, e, e);
+    return quick_two_sum(u, e + f);
+  }
+
+  friend DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b) {
+    return a + -b;
+  }
+
+  //  lo * lo is below the last kept bit and dropped
+  friend DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b) {
+    const double p = a.hi_ * b.hi_;
+    const double e = std::fma(a.hi_, b.hi_, -p);
+    return quick_two_sum(p, std::fma(a.hi_, b.lo_, std::fma(a.lo_, b.hi_, e)));
+  }
+
+  friend DoubleDouble squared(const DoubleDouble& x) {
+    const double p = x.hi_ * x.hi_;
+    const double e = std::fma(x.hi_, x.hi_, -p);
+    return quick_two_sum(p, std::fma(2 * x.hi_, x.lo_, e));
+  }
+
+  friend bool operator<(const DoubleDouble& a, const DoubleDouble& b) {
+    return a.hi_ < b.hi_ || (a.hi_ == b.hi_ && a.lo_ < b.lo_);
+  }
+
+  friend bool operator<=(const DoubleDouble& a, const DoubleDouble& b) {
+    return !(b < a);
+  }
+
+ private:
+  DoubleDouble(const double& hi, const double& lo) : hi_(hi), lo_(lo) {}
+
+  //  a + b = s + e exactly
+  static double two_sum(const double& a, const double& b, double& e) {
+    const double s = a + b;
+    const double v = s - a;
+    e = (a - (s - v)) + (b - v);
+    return s;
+  }
+
+  //  the same for |a| >= |b|
+  static double quick_two_sum(const double& a, const double& b, double& e) {
+    const double s = a + b;
+    e = b - (s - a);
+    return s;
+  }
+
+  static DoubleDouble quick_two_sum(const double& a, const double& b) {
+    double e;
+    const double s = quick_two_sum(a, b, e);
+    return {s, e};
+  }
+
+  double hi_ = 0, lo_ = 0;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+
+#include "formula.hh"
+
+//  an orbit that leaves the disk of this radius diverges
+constexpr int ESCAPE_RADIUS = 4;
+
+//  fraction of the pixel spacing within which an orbit has to return to a
+//  checkpoint to be considered periodic, and so interior
+constexpr double PERIOD_TOLERANCE = 1e-3;
+
+//  closed-form interior test for the two largest components, whose points
+//  would otherwise burn the whole iteration budget
+//  main cardioid: q (q + x - 1/4) <= y^2 / 4 with q = (x - 1/4)^2 + y^2
+//  period-2 bulb: (x + 1)^2 + y^2 <= 1/16
+template <typename T>
+inline bool in_cardioid_or_bulb(const T& re, const T& im) {
+  const T im_2 = squared(im);
+  const T x = re - T(0.25);
+  const T q = squared(x) + im_2;
+  return q * (q + x) <= T(0.25) * im_2 ||
+         squared(re + T(1)) + im_2 <= T(0.0625);
+}
+
+//  Milnor's exterior distance estimate 2 |z| ln|z| / |dz/dc| from the
+//  squared norms of an escaped z and of its derivative, within a factor of
+//  four of the true distance to the set
+inline double distance_estimate(const double& z_norm,
+                                const double& derivative_norm) {
+  return std::sqrt(z_norm / derivative_norm) * std::log(z_norm);
+}
+
+//  number of Formula steps taken before |z| reaches ESCAPE_RADIUS,
+//  max_iteration for points that never escape, (re_0, im_0) is c for the
+//  Mandelbrot set and z_0 for a Julia set
+//  Brent's cycle detection compares every z against a checkpoint that moves
+//  up to the current z whenever the iteration reaches a power of two, an
+//  orbit returning within `tolerance` of it has settled on a cycle, the
+//  distance to it is compared in double, squared in a fixed point T it
+//  would round down to 0 long before the tolerance does
+//  with `distance` set dz/dc is followed as well and the distance estimate
+//  stored there, 0 for points that never escape, the derivative is kept in
+//  double whatever T is as it only needs range, not precision
+template <typename Formula, typename T>
+inline int escape_time(const T& re_0, const T& im_0, const int& max_iteration,
+                       const double& tolerance, const Seed& seed,
+                       double* distance = nullptr) {
+  if (distance) *distance = 0;
+  if (Formula::quadratic && !seed.julia && in_cardioid_or_bulb(re_0, im_0))
+    return max_iteration;
+
+  const T bailout = squared(T(ESCAPE_RADIUS));
+  const double tolerance_2 = squared(tolerance);
+
+  //  a Julia set starts at the pixel with dz/dz_0 = 1 and adds nothing to
+  //  the derivative per step
+  T re = 0, im = 0, c_re = re_0, c_im = im_0;
+  double der_re = 0, der_im = 0, der_one = 1;
+  if (seed.julia) {
+    re = re_0, im = im_0, c_re = seed.re, c_im = seed.im;
+    der_re = 1, der_one = 0;
+  }
+
+  T check_re = re, check_im = im;
+  int iteration = 0, check_at = 1;
+  while (iteration < max_iteration && squared(re) + squared(im) < bailout) {
+    if (distance)
+      Formula::derivative(static_cast<double>(re), static_cast<double>(im),
+                          der_re, der_im, der_one);
+
+    Formula::step(re, im, c_re, c_im);
+    ++iteration;
+
+    if (squared(static_cast<double>(re - check_re)) +
+            squared(static_cast<double>(im - check_im)) <
+        tolerance_2)
+      return max_iteration;
+    if (iteration == check_at) {
+      check_re = re, check_im = im;
+      check_at <<= 1;
+    }
+  }
+
+  if (distance && iteration < max_iteration)
+    *distance = distance_estimate(
+        static_cast<double>(squared(re) + squared(im)),
+        squared(der_re) + squared(der_im));
+  return iteration;
+}
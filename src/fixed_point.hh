@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "bignum.hh"
+
+//  signed fixed point in a 128-bit integer with 11 integer bits, enough for
+//  every intermediate up to the step that escapes, where |z| can reach
+//  ESCAPE_RADIUS^2 + |c| and its distance to a periodicity checkpoint
+//  somewhat more, and 116 fractional bits, more than either long double or
+//  quad keeps around |c| ~ 1
+//  products come out of four 64 x 64 -> 128 bit multiplies, which keeps the
+//  whole kernel on the integer units instead of software floats
+class FixedPoint {
+ public:
+  static constexpr int FRACTION_BITS = 116;
+
+  FixedPoint() = default;
+
+  FixedPoint(const int& value)
+      : value_(static_cast<__int128>(value) << FRACTION_BITS) {}
+
+  FixedPoint(const double& value)
+      : FixedPoint(static_cast<long double>(value)) {}
+
+  FixedPoint(const long double& value)
+      : value_(static_cast<__int128>(std::ldexp(value, FRACTION_BITS))) {}
+
+  //  the leading FRACTION_BITS fractional bits of the number
+  explicit FixedPoint(const Bignum& value) {
+    unsigned __int128 magnitude = 0;
+    for (int i{}, shift = FRACTION_BITS; shift > -Bignum::LIMB_BITS;
+         ++i, shift -= Bignum::LIMB_BITS) {
+      const unsigned __int128 limb = value.limb(i);
+      magnitude += shift >= 0 ? limb << shift : limb >> -shift;
+    }
+    value_ = value.negative() ? -static_cast<__int128>(magnitude)
+                              : static_cast<__int128>(magnitude);
+  }
+
+  explicit operator long double() const {
+    return std::ldexp(static_cast<long double>(value_), -FRACTION_BITS);
+  }
+
+  //  from the two words, the periodicity test converts on every iteration
+  //  and the 128-bit and x87 conversions are library calls
+  explicit operator double() const {
+    return std::ldexp(1.0, 64 - FRACTION_BITS) *
+               static_cast<double>(static_cast<std::int64_t>(value_ >> 64)) +
+           std::ldexp(1.0, -FRACTION_BITS) *
+               static_cast<double>(static_cast<std::uint64_t>(value_));
+  }
+
+  FixedPoint operator-() const { return raw(-value_); }
+
+  friend FixedPoint operator+(const FixedPoint& a, const FixedPoint& b) {
+    return raw(a.value_ + b.value_);
+  }
+
+  friend FixedPoint operator-(const FixedPoint& a, const FixedPoint& b) {
+    return raw(a.value_ - b.value_);
+  }
+
+  //  the 256-bit product floored back to FRACTION_BITS, the operands are
+  //  split into a signed high and an unsigned low word so that no sign
+  //  handling is needed:
+  //  x y = x_1 y_1 2^128 + (x_1 y_0 + x_0 y_1) 2^64 + x_0 y_0
+  friend FixedPoint operator*(const FixedPoint& a, const FixedPoint& b) {
+    const std::int64_t x_1 = a.value_ >> 64, y_1 = b.value_ >> 64;
+    const std::uint64_t x_0 = a.value_, y_0 = b.value_;
+
+    const unsigned __int128 low = static_cast<unsigned __int128>(x_0) * y_0;
+    const __int128 middle_1 = static_cast<__int128>(x_1) * y_0;
+    const __int128 middle_2 = static_cast<__int128>(y_1) * x_0;
+    const __int128 high = static_cast<__int128>(x_1) * y_1;
+
+    //  bits 64 to 127 of the product and the carry out of them
+    const unsigned __int128 middle = (low >> 64) +
+                                     static_cast<std::uint64_t>(middle_1) +
+                                     static_cast<std::uint64_t>(middle_2);
+    const __int128 upper = high + (middle_1 >> 64) + (middle_2 >> 64) +
+                           static_cast<__int128>(middle >> 64);
+    const unsigned __int128 lower =
+        middle << 64 | static_cast<std::uint64_t>(low);
+
+    return raw(static_cast<__int128>(
+        static_cast<unsigned __int128>(upper) << (128 - FRACTION_BITS) |
+        lower >> FRACTION_BITS));
+  }
+
+  friend bool operator<(const FixedPoint& a, const FixedPoint& b) {
+    return a.value_ < b.value_;
+  }
+
+  friend bool operator<=(const FixedPoint& a, const FixedPoint& b) {
+    return a.value_ <= b.value_;
+  }
+
+ private:
+  static FixedPoint raw(const __int128& value) {
+    FixedPoint result;
+    result.value_ = value;
+    return result;
+  }
+
+  __int128 value_ = 0;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+//  double mantissa in [1, 2) with a separate 32-bit exponent, so deltas keep
+//  their full 53 bits far below the smallest normal double
+//  normalization only touches the exponent bits instead of calling frexp,
+//  values are scalars, the perturbed loop runs one pixel at a time as its
+//  BLA steps and rebases differ from pixel to pixel
+class FloatExp {
+ public:
+  FloatExp() = default;
+
+  FloatExp(const double& value) {
+    if (std::fpclassify(value) == FP_SUBNORMAL)
+      *this = FloatExp(static_cast<long double>(value));
+    else
+      *this = normalized(value, 0);
+  }
+
+  FloatExp(const long double& value) {
+    int exponent;
+    const long double mantissa = std::frexp(value, &exponent);
+    *this = normalized(static_cast<double>(mantissa), exponent);
+  }
+
+  explicit operator double() const {
+    if (exponent_ < -1100) return 0;
+    return std::ldexp(mantissa_, exponent_);
+  }
+
+  explicit operator long double() const {
+    return std::ldexp(static_cast<long double>(mantissa_), exponent_);
+  }
+
+  FloatExp operator-() const { return {-mantissa_, exponent_}; }
+
+  friend FloatExp operator*(const FloatExp& a, const FloatExp& b) {
+    return normalized(a.mantissa_ * b.mantissa_, a.exponent_ + b.exponent_);
+  }
+
+  friend FloatExp operator+(const FloatExp& a, const FloatExp& b) {
+    if (a.exponent_ < b.exponent_) return b + a;
+
+    //  b only contributes if it lies within a double's range below a
+    const std::int32_t shift = b.exponent_ - a.exponent_;
+    if (shift < -MAX_SHIFT) return a;
+    return normalized(a.mantissa_ + b.mantissa_ * power_of_two(shift),
+                      a.exponent_);
+  }
+
+  friend FloatExp operator-(const FloatExp& a, const FloatExp& b) {
+    return a + -b;
+  }
+
+  friend bool operator<(const FloatExp& a, const FloatExp& b) {
+    return (a - b).mantissa_ < 0;
+  }
+
+  FloatExp& operator+=(const FloatExp& other) { return *this = *this + other; }
+  FloatExp& operator*=(const FloatExp& other) { return *this = *this * other; }
+
+ private:
+  //  zero is a zero mantissa with an exponent below any real value
+  static constexpr std::int32_t ZERO_EXPONENT = -(1 << 30);
+  static constexpr std::int32_t MAX_SHIFT = 1022;
+  static constexpr std::uint64_t EXPONENT_MASK = 0x7ffull << 52;
+
+  FloatExp(const double& mantissa, const std::int32_t& exponent)
+      : mantissa_(mantissa), exponent_(exponent) {}
+
+  //  2^shift for shift in [-1022, 0]
+  static double power_of_two(const std::int32_t& shift) {
+    return std::bit_cast<double>(static_cast<std::uint64_t>(shift + 1023)
+                                 << 52);
+  }
+
+  //  moves the binary exponent of a normal double into the separate one
+  static FloatExp normalized(const double& value,
+                             const std::int32_t& exponent) {
+    if (value == 0) return {};
+
+    const auto bits = std::bit_cast<std::uint64_t>(value);
+    const std::int32_t shift =
+        static_cast<std::int32_t>((bits & EXPONENT_MASK) >> 52) - 1023;
+    return {std::bit_cast<double>((bits & ~EXPONENT_MASK) | (1023ull << 52)),
+            exponent + shift};
+  }
+
+  double mantissa_ = 0;
+  std::int32_t exponent_ = ZERO_EXPONENT;
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <cmath>
+#include <type_traits>
+
+//  a formula is a type whose static step advances z -> f(z) + c for any
+//  scalar or SIMD lane type, kernels are templates over it so every fractal
+//  gets its own fully inlined inner loop and nothing is dispatched per
+//  iteration
+//  derivative advances dz/dc, or dz/dz_0 for Julia sets where `one` is 0,
+//  in double whatever the orbit is iterated in
+
+//  which fractal a frame renders, cycled with F
+enum class Fractal { Mandelbrot, Multibrot3, Multibrot4, BurningShip };
+
+//  the Mandelbrot set iterates z from 0 with c at the pixel, a Julia set
+//  iterates z from the pixel with a fixed c, toggled with J
+struct Seed {
+  bool julia = false;
+  double re = 0, im = 0;
+};
+
+//  formulas are instantiated for raw vector lanes without carrying their
+//  target attribute, so the helpers they call work in place, a function
+//  returning a vector by value would change the ABI
+
+template <typename T>
+inline T squared(const T& x) {
+  return x * x;
+}
+
+//  out = x^2, types with a cheaper square than a product, such as
+//  DoubleDouble, overload squared
+template <typename T>
+inline void square_into(const T& x, T& out) {
+  if constexpr (std::is_class_v<T>)
+    out = squared(x);
+  else
+    out = x * x;
+}
+
+//  x = |x|
+template <typename T>
+inline void make_absolute(T& x) {
+  if (x < T(0)) x = -x;
+}
+
+//  raw vector lanes clear their sign bits, these have to be declared before
+//  the formulas as plain vector types have no namespace to look them up in
+__attribute__((target("avx2"))) inline void make_absolute(__m256d& x) {
+  x = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+__attribute__((target("avx2"))) inline void make_absolute(__m256& x) {
+  x = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+__attribute__((target("avx512f"))) inline void make_absolute(__m512d& x) {
+  x = _mm512_abs_pd(x);
+}
+
+__attribute__((target("avx512f"))) inline void make_absolute(__m512& x) {
+  x = _mm512_abs_ps(x);
+}
+
+//  z^POWER by repeated squaring, unrolled at compile time
+template <int POWER, typename T>
+inline void complex_power(const T& re, const T& im, T& out_re, T& out_im) {
+  static_assert(POWER >= 1);
+  if constexpr (POWER == 1) {
+    out_re = re, out_im = im;
+  } else if constexpr (POWER % 2 == 0) {
+    T half_re, half_im, half_re_2, half_im_2;
+    complex_power<POWER / 2>(re, im, half_re, half_im);
+    square_into(half_re, half_re_2), square_into(half_im, half_im_2);
+    out_re = half_re_2 - half_im_2;
+    out_im = (half_re + half_re) * half_im;
+  } else {
+    T rest_re, rest_im;
+    complex_power<POWER - 1>(re, im, rest_re, rest_im);
+    out_re = rest_re * re - rest_im * im;
+    out_im = rest_re * im + rest_im * re;
+  }
+}
+
+//  z = z^POWER + c
+template <int POWER>
+struct Multibrot {
+  static constexpr int power = POWER;
+
+  //  the cardioid and bulb test, perturbation, series and BLA are all
+  //  derived for z^2 + c only
+  static constexpr bool quadratic = POWER == 2;
+
+  template <typename T>
+  static void step(T& re, T& im, const T& c_re, const T& c_im) {
+    T p_re, p_im;
+    complex_power<POWER>(re, im, p_re, p_im);
+    re = p_re + c_re, im = p_im + c_im;
+  }
+
+  //  dz' = p z^(p - 1) dz + one
+  static void derivative(const double& re, const double& im, double& der_re,
+                         double& der_im, const double& one) {
+    double p_re, p_im;
+    complex_power<POWER - 1>(re, im, p_re, p_im);
+    p_re *= POWER, p_im *= POWER;
+    const double curr_der_re = der_re;
+    der_re = p_re * der_re - p_im * der_im + one;
+    der_im = p_re * der_im + p_im * curr_der_re;
+  }
+};
+
+using Mandelbrot = Multibrot<2>;
+
+//  z = (|re| + i |im|)^2 + c
+struct BurningShip {
+  static constexpr int power = 2;
+  static constexpr bool quadratic = false;
+
+  template <typename T>
+  static void step(T& re, T& im, const T& c_re, const T& c_im) {
+    T re_2, im_2;
+    make_absolute(re), make_absolute(im);
+    square_into(re, re_2), square_into(im, im_2);
+    im = (re + re) * im + c_im;
+    re = re_2 - im_2 + c_re;
+  }
+
+  //  the fold is a reflection, so the derivative is reflected with z
+  static void derivative(const double& re, const double& im, double& der_re,
+                         double& der_im, const double& one) {
+    const double x = std::abs(re), y = std::abs(im);
+    const double d_re = std::copysign(1.0, re) * der_re;
+    const double d_im = std::copysign(1.0, im) * der_im;
+    der_re = 2 * (x * d_re - y * d_im) + one;
+    der_im = 2 * (x * d_im + y * d_re);
+  }
+};
+
+//  calls visitor(Formula{}) with the formula type of `fractal`, once per
+//  batch rather than per iteration
+template <typename Visitor>
+inline decltype(auto) visit_formula(const Fractal& fractal,
+                                    Visitor&& visitor) {
+  switch (fractal) {
+    case Fractal::Multibrot3:
+      return visitor(Multibrot<3>{});
+    case Fractal::Multibrot4:
+      return visitor(Multibrot<4>{});
+    case Fractal::BurningShip:
+      return visitor(BurningShip{});
+    default:
+      return visitor(Mandelbrot{});
+  }
+}
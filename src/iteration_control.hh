@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+//  the cap never drops below this, so a view that is all interior for a
+//  frame still has room to show its exterior again
+constexpr int MIN_ITERATION = 64;
+
+//  the cap is kept this factor above the iteration count by which the
+//  wanted share of exterior pixels escaped, and only lowered once it is
+//  this factor above that again, which keeps it from oscillating
+constexpr double ITERATION_HEADROOM = 1.25;
+
+//  per frame bounds on how fast the cap may change, growing is bounded
+//  tighter so deeper views cost at most this much more per frame
+constexpr double ITERATION_GROWTH = 1.5, ITERATION_SHRINK = 0.5;
+
+//  sets the next frame's MAX_ITERATION from the escape times of the last
+//  one: pixels below the cap escaped, those at it are interior or would
+//  need more iterations
+//  if more than the unresolved share of exterior pixels escaped within the
+//  headroom below the cap, their tail is cut off and the cap grows, if
+//  the wanted share already escaped far below the cap, the interior is
+//  iterated for nothing and the cap shrinks
+class IterationController {
+ public:
+  //  share of exterior pixels allowed to stay unresolved
+  explicit IterationController(const double& unresolved = 0.005)
+      : unresolved_(unresolved) {}
+
+  //  a finer or coarser target, bound to the mouse wheel
+  void finer() { unresolved_ = std::max(unresolved_ / 2, 1e-5); }
+  void coarser() { unresolved_ = std::min(unresolved_ * 2, 0.1); }
+
+  int next(const std::vector<int>& frame, const int& max_iteration) const {
+    std::vector<int> histogram(max_iteration + 1);
+    for (const int& iteration : frame)
+      ++histogram[std::clamp(iteration, 0, max_iteration)];
+
+    const long long exterior = frame.size() - histogram[max_iteration];
+    if (exterior == 0) return max_iteration;
+
+    //  iteration by which all but the unresolved share escaped, and how
+    //  many escaped within the headroom below the cap
+    const long long resolved = exterior - unresolved_ * exterior;
+    long long escaped = 0, near_cap = 0;
+    int resolved_at = 0;
+    const int band = max_iteration / ITERATION_HEADROOM;
+    for (int i{}; i < max_iteration; ++i) {
+      escaped += histogram[i];
+      if (escaped < resolved) resolved_at = i + 1;
+      if (i >= band) near_cap += histogram[i];
+    }
+
+    double target = max_iteration;
+    if (near_cap > unresolved_ * exterior)
+      target = max_iteration * ITERATION_GROWTH;
+    else if (resolved_at * ITERATION_HEADROOM * ITERATION_HEADROOM <
+             max_iteration)
+      target = std::max(resolved_at * ITERATION_HEADROOM * ITERATION_HEADROOM,
+                        max_iteration * ITERATION_SHRINK);
+    return std::max<int>(MIN_ITERATION, target);
+  }
+
+ private:
+  double unresolved_;
+};
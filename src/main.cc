@@ -1,31 +1,77 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "bignum.hh"
+#include "double_double.hh"
+#include "escape.hh"
+#include "fixed_point.hh"
+#include "formula.hh"
+#include "iteration_control.hh"
+#include "orbit_cache.hh"
+#include "perturbation.hh"
+#include "pixel_reuse.hh"
+#include "precision.hh"
+#include "progressive.hh"
+#include "simd.hh"
+#include "subdivision.hh"
+#include "thread_pool.hh"
+
 constexpr int WIDTH = 640, HEIGHT = 360;
 constexpr long double ASPECT_RATIO = WIDTH / HEIGHT;
-constexpr int INFINITY = 4;
-constexpr long double ZOOM_FACTOR = 1.5;
-constexpr long double ITERATION_DELTA = 8;
-constexpr long double START_X = -0.938258087226625480867497203219,
-                      START_Y = 0.261313681594769599639011686820;
-// constexpr long double
-//     START_X =
-//         -1.9997740601362903593126807559602500475710416233856384007148508574291012335984591928248364190215796259575718318799960175396106897245889581254834492701372949636783094955897931317174101259095891469501748126725148714587333938548443819033709904187344921523413310221887295870857771431011674873342592895504186325482220668710775749899926429101099841583206278295793058921625817004481783699245865364627140554117737774937789463895102748671351750212506004241754983473339789940659968568850689353099462034492524909310777724611601104714214019347435268544619054369865904944457792527241696528695821059623303046651934176389789308453627525109367436309636375268231073110318555064708363221007235298404379856922536028913291478442839193381367508575286692330907891402483843152933153748354825108021776358693600801782904774626935265722056455978643513448489091026679036353407968495795003386248005939867069799946547181378474054113117046900560609110812439442002663909295191705374444149326937073460052706389967886211172676612720028299452788285465688867116337489531157494508508315428488520037968118008255840569742557333862639124341116894229885253643651920014148109308402199399127712572209466874971603743536096235390414412927589954662603878558182262865151900604451937214289079939337905846647369517138325441736853526711818853134657265043099539402286244220638999824999819000131999789999857999958,
-//     START_Y =
-//         -0.0000000032900403214794350534969786759266805967852946505878410088326046927853549452991056352681196631150325234171525664335353457621247922992470898021063583060218954321140472066153878996044171428801408137278072521468882260382336298800961530905692393992277070012433445706657829475924367459793505729004118759963065667029896464160298608486277109065108339157276150465318584383757554775431988245033409975361804443001325241206485033571912765723551757793318752425925728969073157628495924710926832527350298951594826689051400340011140584507852761857568007670527511272585460136585523090533629795012272916453744029579624949223464015705500594059847850617137983380334184205468184810116554041390142120676993959768153409797953194054452153167317775439590270326683890021272963306430827680201998682699627962109145863135950941097962048870017412568065614566213639455841624790306469846132055305041523313740204187090956921716703959797752042569621665723251356946610646735381744551743865516477084313729738832141633286400726001116308041460406558452004662264165125100793429491308397667995852591271957435535504083325331161340230101590756539955554407081416407239097101967362512942992702550533040602039494984081681370518238283847808934080198642728761205332894028474812918370467949299531287492728394399650466260849557177609714181271299409118059191938687461000000000000000000000000000000000000;
+//  an integer, so a zoom keeps every ZOOM_FACTOR-th pixel of each row and
+//  column of the previous frame, see zoom_pixels
+constexpr int ZOOM_FACTOR = 2;
+//  decimal strings, parsed at full precision into the view center
+constexpr const char *START_X = "-0.938258087226625480867497203219",
+                     *START_Y = "0.261313681594769599639011686820";
+// constexpr const char
+//     *START_X =
+//         "-1.9997740601362903593126807559602500475710416233856384007148508574291012335984591928248364190215796259575718318799960175396106897245889581254834492701372949636783094955897931317174101259095891469501748126725148714587333938548443819033709904187344921523413310221887295870857771431011674873342592895504186325482220668710775749899926429101099841583206278295793058921625817004481783699245865364627140554117737774937789463895102748671351750212506004241754983473339789940659968568850689353099462034492524909310777724611601104714214019347435268544619054369865904944457792527241696528695821059623303046651934176389789308453627525109367436309636375268231073110318555064708363221007235298404379856922536028913291478442839193381367508575286692330907891402483843152933153748354825108021776358693600801782904774626935265722056455978643513448489091026679036353407968495795003386248005939867069799946547181378474054113117046900560609110812439442002663909295191705374444149326937073460052706389967886211172676612720028299452788285465688867116337489531157494508508315428488520037968118008255840569742557333862639124341116894229885253643651920014148109308402199399127712572209466874971603743536096235390414412927589954662603878558182262865151900604451937214289079939337905846647369517138325441736853526711818853134657265043099539402286244220638999824999819000131999789999857999958",
+//     *START_Y =
+//         "-0.0000000032900403214794350534969786759266805967852946505878410088326046927853549452991056352681196631150325234171525664335353457621247922992470898021063583060218954321140472066153878996044171428801408137278072521468882260382336298800961530905692393992277070012433445706657829475924367459793505729004118759963065667029896464160298608486277109065108339157276150465318584383757554775431988245033409975361804443001325241206485033571912765723551757793318752425925728969073157628495924710926832527350298951594826689051400340011140584507852761857568007670527511272585460136585523090533629795012272916453744029579624949223464015705500594059847850617137983380334184205468184810116554041390142120676993959768153409797953194054452153167317775439590270326683890021272963306430827680201998682699627962109145863135950941097962048870017412568065614566213639455841624790306469846132055305041523313740204187090956921716703959797752042569621665723251356946610646735381744551743865516477084313729738832141633286400726001116308041460406558452004662264165125100793429491308397667995852591271957435535504083325331161340230101590756539955554407081416407239097101967362512942992702550533040602039494984081681370518238283847808934080198642728761205332894028474812918370467949299531287492728394399650466260849557177609714181271299409118059191938687461000000000000000000000000000000000000";
 constexpr int FRAME_RATE = 30;
+//  share of the view the arrow keys and WASD pan by
+constexpr long double PAN_SHARE = 0.3;
+//  a left button press that moves less than this many pixels before its
+//  release is a click that zooms in, a longer move drags the view
+constexpr int DRAG_THRESHOLD = 4;
+//  reference orbits are also kept on disk here so the next run starts from
+//  them, e.g. "./cache", empty keeps them in memory only
+constexpr const char* ORBIT_CACHE_DIRECTORY = "";
+//  reference orbits too long for memory are mapped from files here, which
+//  has to be on disk for them to leave memory, not on a tmpfs like /tmp
+//  often is, empty keeps them in memory
+constexpr const char* ORBIT_SPILL_DIRECTORY = ".";
+//  width of the dark band distance estimation draws along the boundary
+constexpr long double DEM_THICKNESS = 2;
+constexpr int TILE_SIZE = 16;
+constexpr int TILES_X = (WIDTH + TILE_SIZE - 1) / TILE_SIZE,
+              TILES_Y = (HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+//  subdivision starts from larger blocks so uniform areas are filled in
+//  bigger pieces
+constexpr int SUBDIVISION_BLOCK = 4 * TILE_SIZE;
+constexpr int BLOCKS_X = (WIDTH + SUBDIVISION_BLOCK - 1) / SUBDIVISION_BLOCK,
+              BLOCKS_Y = (HEIGHT + SUBDIVISION_BLOCK - 1) / SUBDIVISION_BLOCK;
 
 int MAX_ITERATION = 128;
-long double min_re = -2, max_re = 2;
-long double min_im = -1, max_im = 1;
 
-template <typename T>
-inline T squared(const T& x) {
-  return x * x;
-}
+//  view center in arbitrary precision, widened as the view zooms in
+Bignum center_re(START_X), center_im(START_Y);
+//  half extents of the view
+long double radius_re = 2, radius_im = 1;
 
 int main() {
   std::unique_ptr<sf::RenderWindow> window(
@@ -39,33 +85,44 @@ int main() {
       (sf::VideoMode::getDesktopMode().width - window->getSize().x) * 0.5,
       (sf::VideoMode::getDesktopMode().height - window->getSize().y) * 0.5));
 
-  sf::Image image;
-  image.create(WIDTH, HEIGHT);
+  //  triple buffered frames: the render thread draws into `back`, swaps it
+  //  with `ready` once done, and the window takes `ready` as its `front`
+  //  whenever a newer one is there, neither ever waits for the other
+  sf::Image images[3];
+  for (auto& image : images) image.create(WIDTH, HEIGHT);
+  int back = 0, ready = 1, front = 2;
+  bool fresh = false;
+  std::mutex present_mutex;
 
   sf::Texture texture;
-  sf::Sprite sprite;
+  texture.create(WIDTH, HEIGHT);
+  sf::Sprite sprite(texture);
+
+  //  distance between neighbouring pixels
+  auto spacing = [] {
+    return std::min(2 * radius_re / WIDTH, 2 * radius_im / HEIGHT);
+  };
+
+  //  moves the center by an offset, growing its precision first so the
+  //  offset's bits below the current last limb are kept
+  auto move = [&](const long double& re_delta, const long double& im_delta) {
+    const int limbs = reference_limbs(spacing());
+    center_re.set_limbs(std::max(center_re.limbs(), limbs));
+    center_im.set_limbs(std::max(center_im.limbs(), limbs));
+    center_re += Bignum(re_delta, center_re.limbs());
+    center_im += Bignum(im_delta, center_im.limbs());
+  };
 
   auto zoom = [&](const long double& pos_x, const long double& pos_y,
                   const long double& z) {
     //  changing the center to the mouse click point
-    long double re_0 = min_re + (max_re - min_re) * pos_x / WIDTH;
-    long double im_0 = min_im + (max_im - min_im) * pos_y / HEIGHT;
-
-    if (z > 1)
-      MAX_ITERATION += ITERATION_DELTA;
-    else
-      MAX_ITERATION -= ITERATION_DELTA;
+    long double re_0 = radius_re * (2 * pos_x / WIDTH - 1);
+    long double im_0 = radius_im * (2 * pos_y / HEIGHT - 1);
 
     //  zoom
-    long double scaled_min_re = re_0 - (max_re - min_re) / 2.0 / z;
-    long double scaled_max_re = re_0 + (max_re - min_re) / 2.0 / z;
-    min_re = scaled_min_re;
-    max_re = scaled_max_re;
-
-    long double scaled_min_im = im_0 - (max_im - min_im) / 2.0 / z;
-    long double scaled_max_im = im_0 + (max_im - min_im) / 2.0 / z;
-    min_im = scaled_min_im;
-    max_im = scaled_max_im;
+    radius_re /= z;
+    radius_im /= z;
+    move(re_0, im_0);
   };
 
   //  linear interpolation
@@ -89,112 +146,568 @@ int main() {
     return new_val;
   };
 
-  long long cnt = 0;
-  while (window->isOpen()) {
-    sf::Event event;
-    while (window->pollEvent(event)) {
-      if (event.type == sf::Event::Closed) window->close();
+  auto colorize = [&](const int& iteration) -> sf::Color {
+    // color pallet similar to Ultra Fractal and Wikipedia
+    static const std::vector<sf::Color> colors{
+        {0, 7, 100},   {32, 107, 203}, {237, 255, 255},
+        {255, 170, 0}, {0, 2, 0},
+    };
+    // static const std::vector<sf::Color> colors{
+    //     {0, 0, 0},     {213, 67, 31}, {251, 255, 121},
+    //     {62, 223, 89}, {43, 30, 218}, {0, 255, 247}};
+
+    static const auto max_color = colors.size() - 1;
+
+    // if (iteration == MAX_ITERATION) iteration = 0;
+
+    long double mu = 1.0 * iteration / MAX_ITERATION;
+    mu *= max_color;
+    size_t i_mu = static_cast<std::size_t>(mu);
+    sf::Color col_1 = colors[i_mu];
+    sf::Color col_2 = colors[std::min(i_mu + 1, max_color)];
+    return lerp(col_1, col_2, mu - i_mu);
+  };
 
-      if (event.type == sf::Event::KeyPressed) {
-        //  move delta
-        long double x_delta = (max_re - min_re) * ASPECT_RATIO * 0.3;
-        long double y_delta = (max_im - min_im) * (1.0 / ASPECT_RATIO) * 0.3;
-
-        if (event.key.code == sf::Keyboard::Left ||
-            event.key.code == sf::Keyboard::A) {
-          min_re -= x_delta, max_re -= x_delta;
-        } else if (event.key.code == sf::Keyboard::Right ||
-                   event.key.code == sf::Keyboard::D) {
-          min_re += x_delta, max_re += x_delta;
-        } else if (event.key.code == sf::Keyboard::Up ||
-                   event.key.code == sf::Keyboard::W) {
-          min_im -= y_delta, max_im -= y_delta;
-        } else if (event.key.code == sf::Keyboard::Down ||
-                   event.key.code == sf::Keyboard::S) {
-          min_im += y_delta, max_im += y_delta;
-        }
+  //  darkens a color towards the boundary, pixels closer to the set than
+  //  DEM_THICKNESS pixels fade to black so filaments stay visible at
+  //  iteration counts too low for the palette to resolve them
+  auto shade = [&](const sf::Color& color, const float& distance) {
+    const long double t = std::min(1.0L, std::sqrt(distance / DEM_THICKNESS));
+    return lerp(sf::Color::Black, color, t);
+  };
+
+  //  chosen per frame from the pixel spacing
+  Precision precision = Precision::Float;
+
+  //  the formula iterated, and the c of a Julia set taken from the point
+  //  under the mouse when J is pressed
+  Fractal fractal = Fractal::Mandelbrot;
+  Seed seed;
+
+  //  deep frames iterate against a reference orbit at the view center,
+  //  toggled with P to fall back to the long double and quad kernels
+  bool perturbation = true;
+  ReferenceOrbit orbit;
+  OrbitCache orbit_cache(ORBIT_CACHE_DIRECTORY, ORBIT_SPILL_DIRECTORY);
+  SeriesApproximation series;
+  BlaTable bla;
+
+  //  the view center rounded once per frame for the non-perturbed kernels
+  long double view_re = 0, view_im = 0;
+  __float128 view_re_q = 0, view_im_q = 0;
+  DoubleDouble view_re_d, view_im_d;
+  FixedPoint view_re_f, view_im_f;
+
+  //  escape time of every pixel of the last frame, row-major
+  std::vector<int> frame(WIDTH * HEIGHT);
+
+  //  exterior distance estimate in pixels alongside the frame, 0 inside the
+  //  set, only filled in while distance estimation is toggled on with E
+  bool distance_estimation = false;
+  std::vector<float> distance(WIDTH * HEIGHT);
+
+  //  pixels of the frame still valid for the view, and the cap they were
+  //  counted against, only the others are iterated
+  std::vector<char> known(WIDTH * HEIGHT);
+  int known_cap = MAX_ITERATION;
+  auto forget = [&] { std::fill(known.begin(), known.end(), false); };
+
+  //  escape times of a tile's points evaluated in T, the offsets from the
+  //  view center are kept in long double and the center is only added in
+  //  the target precision, distances are only estimated when asked for
+  //  `kernel` iterates the same Formula as the distance estimator
+  auto escape_tile = [&]<typename Formula, typename T>(
+                         const Formula&, const long double* re_offset,
+                         const long double* im_offset, const int& count,
+                         EscapeKernel<T> kernel, int* iterations,
+                         float* distances) {
+    T re[TILE_SIZE * TILE_SIZE], im[TILE_SIZE * TILE_SIZE];
+    for (int i{}; i < count; ++i) {
+      if constexpr (std::is_same_v<T, __float128>) {
+        re[i] = view_re_q + T(re_offset[i]);
+        im[i] = view_im_q + T(im_offset[i]);
+      } else if constexpr (std::is_same_v<T, DoubleDouble>) {
+        re[i] = view_re_d + T(re_offset[i]);
+        im[i] = view_im_d + T(im_offset[i]);
+      } else if constexpr (std::is_same_v<T, FixedPoint>) {
+        re[i] = view_re_f + T(re_offset[i]);
+        im[i] = view_im_f + T(im_offset[i]);
+      } else {
+        re[i] = view_re + re_offset[i];
+        im[i] = view_im + im_offset[i];
       }
+    }
+    if (distances)
+      escape_distance<Formula>(re, im, count, MAX_ITERATION, spacing(), seed,
+                               iterations, distances);
+    else
+      kernel(re, im, count, MAX_ITERATION, PERIOD_TOLERANCE * spacing(), seed,
+             iterations);
+  };
 
-      if (event.type == sf::Event::MouseButtonPressed) {
-        //  left click to zoom in
-        if (event.mouseButton.button == sf::Mouse::Left) {
-          zoom(event.mouseButton.x, event.mouseButton.y, ZOOM_FACTOR);
+  //  escape times of a tile's points as deltas from the reference at the
+  //  view center, the perturbed kernel only sees points the closed-form
+  //  interior test could not settle
+  auto escape_perturbed_tile = [&]<typename D>(const long double* re_offset,
+                                               const long double* im_offset,
+                                               const int& count, D* dc_re,
+                                               D* dc_im, int* iterations,
+                                               float* distances) {
+    int pending[TILE_SIZE * TILE_SIZE], remaining = 0;
+    for (int i{}; i < count; ++i) {
+      if (in_cardioid_or_bulb(view_re + re_offset[i], view_im + im_offset[i])) {
+        iterations[i] = MAX_ITERATION;
+        if (distances) distances[i] = 0;
+      } else {
+        dc_re[remaining] = re_offset[i], dc_im[remaining] = im_offset[i];
+        pending[remaining++] = i;
+      }
+    }
+
+    int results[TILE_SIZE * TILE_SIZE];
+    float estimates[TILE_SIZE * TILE_SIZE];
+    escape_perturbed(orbit, series, bla, dc_re, dc_im, remaining,
+                     MAX_ITERATION, D(spacing()), results,
+                     distances ? estimates : nullptr);
+    for (int k{}; k < remaining; ++k) {
+      iterations[pending[k]] = results[k];
+      if (distances) distances[pending[k]] = estimates[k];
+    }
+  };
+
+  //  escape times of up to TILE_SIZE * TILE_SIZE pixels in the precision
+  //  chosen for the frame, their distance estimates go straight to the
+  //  distance field
+  auto escape_batch = [&](const int* xs, const int* ys, const int& count,
+                          int* iterations) {
+    float estimates[TILE_SIZE * TILE_SIZE];
+    float* distances = distance_estimation ? estimates : nullptr;
+
+    long double re_offset[TILE_SIZE * TILE_SIZE],
+        im_offset[TILE_SIZE * TILE_SIZE];
+    for (int i{}; i < count; ++i) {
+      //  mapping the viewport to the domain
+      re_offset[i] = map_range(xs[i], 0, WIDTH, -radius_re, radius_re);
+      im_offset[i] = map_range(ys[i], 0, HEIGHT, -radius_im, radius_im);
+    }
+
+    //  the formula is settled once per batch, the kernels below are
+    //  instantiated for it
+    visit_formula(fractal, [&]<typename F>(const F& formula) {
+      switch (precision) {
+        case Precision::Float:
+          escape_tile(formula, re_offset, im_offset, count,
+                      simd_backend<F>().f32, iterations, distances);
+          break;
+        case Precision::Double:
+          escape_tile(formula, re_offset, im_offset, count,
+                      simd_backend<F>().f64, iterations, distances);
+          break;
+        case Precision::LongDouble:
+          escape_tile(formula, re_offset, im_offset, count,
+                      escape_scalar<F, long double>, iterations, distances);
+          break;
+        case Precision::DoubleDouble:
+          escape_tile(formula, re_offset, im_offset, count,
+                      simd_backend<F>().dd, iterations, distances);
+          break;
+        case Precision::Fixed:
+          escape_tile(formula, re_offset, im_offset, count,
+                      escape_scalar<F, FixedPoint>, iterations, distances);
+          break;
+        case Precision::Quad:
+          escape_tile(formula, re_offset, im_offset, count,
+                      escape_scalar<F, __float128>, iterations, distances);
+          break;
+        case Precision::Perturbation: {
+          double dc_re[TILE_SIZE * TILE_SIZE], dc_im[TILE_SIZE * TILE_SIZE];
+          escape_perturbed_tile(re_offset, im_offset, count, dc_re, dc_im,
+                                iterations, distances);
+          break;
         }
-        //  right click to zoom out
-        else if (event.mouseButton.button == sf::Mouse::Right) {
-          zoom(event.mouseButton.x, event.mouseButton.y, 1.0 / ZOOM_FACTOR);
+        case Precision::FloatExpPerturbation: {
+          FloatExp dc_re[TILE_SIZE * TILE_SIZE], dc_im[TILE_SIZE * TILE_SIZE];
+          escape_perturbed_tile(re_offset, im_offset, count, dc_re, dc_im,
+                                iterations, distances);
+          break;
         }
       }
+    });
 
-      //  set iteration level by mouse wheel
-      if (event.type == sf::Event::MouseWheelScrolled) {
-        if (event.MouseWheelScrolled) {
-          if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
-            if (event.mouseWheelScroll.delta > 0)
-              MAX_ITERATION = std::max(1, (MAX_ITERATION >> 1));
-            else
-              MAX_ITERATION <<= 1;
-          }
-        }
+    if (distances)
+      for (int i{}; i < count; ++i)
+        distance[ys[i] * WIDTH + xs[i]] = distances[i];
+  };
+
+  //  any number of pixels, in batches, known pixels keep their escape time
+  auto escape_pixels = [&](const int* xs, const int* ys, const int& count,
+                           int* iterations) {
+    std::vector<int> pending_x, pending_y, slots;
+    for (int i{}; i < count; ++i) {
+      if (known[ys[i] * WIDTH + xs[i]]) {
+        iterations[i] = frame[ys[i] * WIDTH + xs[i]];
+      } else {
+        pending_x.push_back(xs[i]), pending_y.push_back(ys[i]);
+        slots.push_back(i);
       }
     }
 
-    window->clear();
+    const int pending = slots.size();
+    std::vector<int> results(pending);
+    for (int i{}; i < pending; i += TILE_SIZE * TILE_SIZE)
+      escape_batch(pending_x.data() + i, pending_y.data() + i,
+                   std::min(pending - i, TILE_SIZE * TILE_SIZE),
+                   results.data() + i);
+    for (int k{}; k < pending; ++k) iterations[slots[k]] = results[k];
+  };
+
+  //  pixels of a frame are either all iterated or, in subdivision mode,
+  //  mostly filled in from uniform rectangle borders, toggled with M
+  RenderMode mode = RenderMode::BruteForce;
+
+  //  pixel step of the brute force pass in progress, 1 when subdividing
+  int pass_step = 1;
+
+  //  set by the window once input makes the frame in progress stale, the
+  //  frame is then abandoned tile by tile and the new view started at once
+  std::atomic<bool> cancel = false;
+
+  //  renders one TILE_SIZE x TILE_SIZE block of the frame at the pass step,
+  //  or one SUBDIVISION_BLOCK x SUBDIVISION_BLOCK block when subdividing
+  auto render_tile = [&](std::size_t tile) {
+    if (cancel.load(std::memory_order_relaxed)) return;
+
+    const int size =
+        mode == RenderMode::Subdivision ? SUBDIVISION_BLOCK : TILE_SIZE;
+    const int tiles_x = (WIDTH + size - 1) / size;
+    const int x_begin = tile % tiles_x * size;
+    const int y_begin = tile / tiles_x * size;
+    const int x_end = std::min(x_begin + size, WIDTH);
+    const int y_end = std::min(y_begin + size, HEIGHT);
+
+    if (mode == RenderMode::Subdivision) {
+      render_subdivided(x_begin, y_begin, x_end, y_end, WIDTH, frame.data(),
+                        distance_estimation ? distance.data() : nullptr,
+                        escape_pixels);
+      for (int y = y_begin; y < y_end; ++y)
+        std::fill(known.begin() + y * WIDTH + x_begin,
+                  known.begin() + y * WIDTH + x_end, true);
+    } else {
+      int xs[TILE_SIZE * TILE_SIZE], ys[TILE_SIZE * TILE_SIZE];
+      int count = 0;
+      for (int y = y_begin; y < y_end; y += pass_step)
+        for (int x = x_begin; x < x_end; x += pass_step)
+          if (!known[y * WIDTH + x]) xs[count] = x, ys[count++] = y;
+
+      int iterations[TILE_SIZE * TILE_SIZE];
+      escape_pixels(xs, ys, count, iterations);
+      for (int i{}; i < count; ++i) {
+        frame[ys[i] * WIDTH + xs[i]] = iterations[i];
+        known[ys[i] * WIDTH + xs[i]] = true;
+      }
+    }
+
+    for (int y = y_begin; y < y_end; ++y)
+      for (int x = x_begin; x < x_end; ++x) {
+        const int sample =
+            known[y * WIDTH + x]
+                ? y * WIDTH + x
+                : (y - y % pass_step) * WIDTH + (x - x % pass_step);
+        images[back].setPixel(x, y,
+                              distance_estimation
+                                  ? shade(colorize(frame[sample]),
+                                          distance[sample])
+                                  : colorize(frame[sample]));
+      }
+  };
+
+  //  workers persist across frames
+  ThreadPool pool;
+
+  //  MAX_ITERATION follows the escape times of the previous frame
+  IterationController iteration_controller;
 
-    //  adding parallelization
-#pragma omp parallel for
-    for (int y{}; y < HEIGHT; ++y) {
-      for (int x{}; x < WIDTH; ++x) {
-        //  mapping the viewport to the domain
-        const long double re_0 =
-            map_range(x, 0, WIDTH, min_re, max_re) + START_X;
-        const long double im_0 =
-            map_range(y, 0, HEIGHT, min_im, max_im) + START_Y;
-
-        long double re = 0, im = 0;
-        int iteration = 0;
-        while (iteration++ < MAX_ITERATION &&
-               squared(re) + squared(im) < squared(INFINITY)) {
-          long double curr_re = re;
-          //  z = z^2 + c
-          re = squared(re) - squared(im) + re_0;
-          im = 2 * curr_re * im + im_0;
+  //  events the window received, handled by the render thread between
+  //  frames so that the view never changes under a frame being computed,
+  //  with the mouse position at the time for J
+  std::vector<std::pair<sf::Event, sf::Vector2i>> input;
+  std::mutex input_mutex;
+
+  //  moves the view by whole pixels, so the pixels still in view keep
+  //  their escape times and only the exposed strips are iterated again
+  auto pan = [&](const int& dx, const int& dy) {
+    move(dx * 2 * radius_re / WIDTH, dy * 2 * radius_im / HEIGHT);
+    shift_pixels(dx, dy, WIDTH, HEIGHT, frame, distance, known);
+  };
+
+  //  the auto-zoom towards the center, paused and resumed with space
+  bool auto_zoom = true;
+
+  //  a left button press is a click or, once it moved past DRAG_THRESHOLD,
+  //  a drag that pans the view along with the mouse
+  bool pressed = false, dragging = false;
+  sf::Vector2i press, last_drag;
+
+  auto handle = [&](const sf::Event& event, const sf::Vector2i& mouse) {
+    if (event.type == sf::Event::KeyPressed) {
+      //  move delta in pixels
+      const int x_delta = std::lround(WIDTH * ASPECT_RATIO * PAN_SHARE);
+      const int y_delta = std::lround(HEIGHT / ASPECT_RATIO * PAN_SHARE);
+
+      //  everything but a pan changes every pixel
+      if (event.key.code == sf::Keyboard::Left ||
+          event.key.code == sf::Keyboard::A) {
+        pan(-x_delta, 0);
+      } else if (event.key.code == sf::Keyboard::Right ||
+                 event.key.code == sf::Keyboard::D) {
+        pan(x_delta, 0);
+      } else if (event.key.code == sf::Keyboard::Up ||
+                 event.key.code == sf::Keyboard::W) {
+        pan(0, -y_delta);
+      } else if (event.key.code == sf::Keyboard::Down ||
+                 event.key.code == sf::Keyboard::S) {
+        pan(0, y_delta);
+      } else if (event.key.code == sf::Keyboard::Space) {
+        auto_zoom = !auto_zoom;
+      } else if (event.key.code == sf::Keyboard::P) {
+        perturbation = !perturbation;
+        forget();
+      } else if (event.key.code == sf::Keyboard::E) {
+        distance_estimation = !distance_estimation;
+        forget();
+      } else if (event.key.code == sf::Keyboard::M) {
+        mode = mode == RenderMode::BruteForce ? RenderMode::Subdivision
+                                              : RenderMode::BruteForce;
+        forget();
+      } else if (event.key.code == sf::Keyboard::F) {
+        fractal = fractal == Fractal::BurningShip
+                      ? Fractal::Mandelbrot
+                      : static_cast<Fractal>(static_cast<int>(fractal) + 1);
+        forget();
+      } else if (event.key.code == sf::Keyboard::J) {
+        //  the Julia set of the point under the mouse
+        seed.julia = !seed.julia;
+        seed.re = static_cast<long double>(center_re) +
+                  map_range(mouse.x, 0, WIDTH, -radius_re, radius_re);
+        seed.im = static_cast<long double>(center_im) +
+                  map_range(mouse.y, 0, HEIGHT, -radius_im, radius_im);
+        forget();
+      }
+    }
+
+    if (event.type == sf::Event::MouseButtonPressed) {
+      //  left click to zoom in, on release unless it turns into a drag
+      if (event.mouseButton.button == sf::Mouse::Left) {
+        pressed = true, dragging = false;
+        press = last_drag = {event.mouseButton.x, event.mouseButton.y};
+      }
+      //  right click to zoom out
+      else if (event.mouseButton.button == sf::Mouse::Right) {
+        zoom(event.mouseButton.x, event.mouseButton.y, 1.0 / ZOOM_FACTOR);
+        forget();
+      }
+    }
+
+    if (event.type == sf::Event::MouseMoved && pressed) {
+      const sf::Vector2i position(event.mouseMove.x, event.mouseMove.y);
+      dragging |= std::abs(position.x - press.x) > DRAG_THRESHOLD ||
+                  std::abs(position.y - press.y) > DRAG_THRESHOLD;
+      if (dragging) {
+        //  the picture follows the mouse, so the view moves against it
+        pan(last_drag.x - position.x, last_drag.y - position.y);
+        last_drag = position;
+      }
+    }
+
+    if (event.type == sf::Event::MouseButtonReleased &&
+        event.mouseButton.button == sf::Mouse::Left && pressed) {
+      pressed = false;
+      if (!dragging) {
+        zoom(press.x, press.y, ZOOM_FACTOR);
+        zoom_pixels(press.x, press.y, ZOOM_FACTOR, WIDTH, HEIGHT, frame,
+                    distance, known);
+      }
+    }
+
+    //  set the share of exterior pixels left unresolved by mouse wheel
+    if (event.type == sf::Event::MouseWheelScrolled) {
+      if (event.MouseWheelScrolled) {
+        if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+          if (event.mouseWheelScroll.delta > 0)
+            iteration_controller.coarser();
+          else
+            iteration_controller.finer();
         }
+      }
+    }
+  };
 
-        // color pallet similar to Ultra Fractal and Wikipedia
-        static const std::vector<sf::Color> colors{
-            {0, 7, 100},   {32, 107, 203}, {237, 255, 255},
-            {255, 170, 0}, {0, 2, 0},
-        };
-        // static const std::vector<sf::Color> colors{
-        //     {0, 0, 0},     {213, 67, 31}, {251, 255, 121},
-        //     {62, 223, 89}, {43, 30, 218}, {0, 255, 247}};
+  //  hands the back image over to the window
+  auto publish = [&] {
+    std::lock_guard<std::mutex> lock(present_mutex);
+    std::swap(back, ready);
+    fresh = true;
+  };
 
-        static const auto max_color = colors.size() - 1;
+  //  false once cancelled, the frame is then only partly drawn
+  //  the coarser passes are shown as soon as they are done once the view
+  //  has `jumped` on input, or once the frame takes longer than the window
+  //  shows one, a quick frame of the auto-zoom goes straight to its last
+  //  pass instead of flickering through all of them
+  auto render_frame = [&](const bool& jumped) {
+    const auto start = std::chrono::steady_clock::now();
+
+    change_cap(known_cap, MAX_ITERATION, frame, distance, known);
+    known_cap = MAX_ITERATION;
+
+    view_re = static_cast<long double>(center_re);
+    view_im = static_cast<long double>(center_im);
+    view_re_q = static_cast<__float128>(center_re);
+    view_im_q = static_cast<__float128>(center_im);
+    view_re_d = DoubleDouble(center_re);
+    view_im_d = DoubleDouble(center_im);
+    view_re_f = FixedPoint(center_re);
+    view_im_f = FixedPoint(center_im);
+
+    //  the reference orbit, series and BLA only know z^2 + c
+    const auto [power, quadratic] = visit_formula(fractal, [](const auto& f) {
+      return std::pair(f.power, f.quadratic);
+    });
+    precision = select_precision(
+        spacing(),
+        std::max(std::abs(view_re) + radius_re, std::abs(view_im) + radius_im),
+        power, perturbation && quadratic && !seed.julia);
+
+    if (precision >= Precision::Perturbation) {
+      //  the center keeps every parsed digit, the orbit only needs enough
+      //  of them for the current depth
+      const int limbs = reference_limbs(spacing());
+      Bignum reference_re = center_re, reference_im = center_im;
+      reference_re.set_limbs(limbs);
+      reference_im.set_limbs(limbs);
+      orbit = orbit_cache.orbit(reference_re, reference_im, MAX_ITERATION,
+                                &pool, &cancel);
+      if (cancel) return false;
+
+      //  the corners and edge midpoints of the view bound the series error
+      std::vector<std::complex<double>> probes;
+      for (const long double& re : {-radius_re, 0.0L, radius_re})
+        for (const long double& im : {-radius_im, 0.0L, radius_im})
+          if (re != 0 || im != 0) probes.emplace_back(re, im);
+      series = precision == Precision::Perturbation
+                   ? approximate_series(orbit, probes, MAX_ITERATION)
+                   : SeriesApproximation();
+      bla = BlaTable(orbit, std::hypot(radius_re, radius_im));
+    }
 
-        // if (iteration == MAX_ITERATION) iteration = 0;
+    //  tiles are handed out to the work-stealing pool
+    if (mode == RenderMode::Subdivision) {
+      pass_step = 1;
+      pool.parallel_for(BLOCKS_X * BLOCKS_Y, render_tile);
+    } else {
+      for (const int& step : PROGRESSIVE_STEPS) {
+        pass_step = step;
+        pool.parallel_for(TILES_X * TILES_Y, render_tile);
+        if (cancel) return false;
+        const bool slow = std::chrono::steady_clock::now() - start >
+                          std::chrono::milliseconds(1000 / FRAME_RATE);
+        if (step > 1 && (jumped || slow)) publish();
+      }
+    }
+    if (cancel) return false;
+    publish();
+    return true;
+  };
+
+  std::atomic<bool> running = true;
+  //  with the auto-zoom paused a frame whose cap did not change would only
+  //  render the same pixels again, so the render thread waits for input
+  std::condition_variable input_arrived;
+  bool settled = false;
+
+  std::thread renderer([&] {
+    long long cnt = 0;
+    while (running) {
+      std::vector<std::pair<sf::Event, sf::Vector2i>> events;
+      {
+        std::unique_lock<std::mutex> lock(input_mutex);
+        if (settled)
+          input_arrived.wait(lock, [&] { return !input.empty() || !running; });
+        //  the window closed, its cancel must not be cleared for one more
+        //  frame
+        if (!running) break;
+        events.swap(input);
+        cancel = false;
+      }
+      bool jumped = false;
+      for (const auto& [event, mouse] : events) {
+        handle(event, mouse);
+        jumped |= event.type != sf::Event::MouseWheelScrolled;
+      }
+
+      //  a cancelled frame is neither shown nor zoomed on from
+      if (!render_frame(jumped)) continue;
 
-        long double mu = 1.0 * iteration / MAX_ITERATION;
-        mu *= max_color;
-        size_t i_mu = static_cast<std::size_t>(mu);
-        sf::Color col_1 = colors[i_mu];
-        sf::Color col_2 = colors[std::min(i_mu + 1, max_color)];
-        sf::Color col = lerp(col_1, col_2, mu - i_mu);
+      // images[ready].saveToFile("./out/mandelbrot" + std::to_string(++cnt) +
+      //                          ".png");
 
-        image.setPixel(x, y, sf::Color(col));
+      const int cap = MAX_ITERATION;
+      MAX_ITERATION = iteration_controller.next(frame, MAX_ITERATION);
+      if (auto_zoom) {
+        zoom(WIDTH / 2, HEIGHT / 2, ZOOM_FACTOR);
+        zoom_pixels(WIDTH / 2, HEIGHT / 2, ZOOM_FACTOR, WIDTH, HEIGHT, frame,
+                    distance, known);
       }
+      settled = !auto_zoom && MAX_ITERATION == cap;
     }
+  });
 
-    texture.loadFromImage(image);
-    sprite.setTexture(texture);
-    window->draw(sprite);
+  //  the window only takes input and presents the newest finished frame, at
+  //  FRAME_RATE however long the render thread needs for one
+  while (window->isOpen()) {
+    sf::Event event;
+    while (window->pollEvent(event)) {
+      if (event.type == sf::Event::Closed) window->close();
 
-    // image.saveToFile("./out/mandelbrot" + std::to_string(++cnt) + ".png");
+      //  mouse moves only matter while dragging, and only the latest of a
+      //  run of them, the pan is relative to the last one handled
+      const bool drag = event.type == sf::Event::MouseMoved &&
+                        sf::Mouse::isButtonPressed(sf::Mouse::Left);
+      if (event.type == sf::Event::KeyPressed ||
+          event.type == sf::Event::MouseButtonPressed ||
+          event.type == sf::Event::MouseButtonReleased ||
+          event.type == sf::Event::MouseWheelScrolled || drag) {
+        std::lock_guard<std::mutex> lock(input_mutex);
+        if (drag && !input.empty() &&
+            input.back().first.type == sf::Event::MouseMoved)
+          input.back() = {event, sf::Mouse::getPosition(*window)};
+        else
+          input.emplace_back(event, sf::Mouse::getPosition(*window));
+        //  the wheel only sets the cap of the frames after
+        if (event.type != sf::Event::MouseWheelScrolled) cancel = true;
+        input_arrived.notify_one();
+      }
+    }
 
-    zoom(WIDTH / 2, HEIGHT / 2, ZOOM_FACTOR);
+    bool present = false;
+    {
+      std::lock_guard<std::mutex> lock(present_mutex);
+      if (fresh) std::swap(ready, front), fresh = false, present = true;
+    }
+    if (present) texture.update(images[front]);
 
+    window->clear();
+    window->draw(sprite);
     window->display();
   }
 
+  {
+    std::lock_guard<std::mutex> lock(input_mutex);
+    running = false;
+    cancel = true;
+  }
+  input_arrived.notify_one();
+  renderer.join();
+
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bignum.hh"
+#include "reference_orbit.hh"
+
+//  orbits kept in memory, the most recently used first, enough to pan back
+//  and forth between a few centers
+constexpr int ORBIT_CACHE_SIZE = 8;
+
+//  reference orbits by center and precision, kept across frames
+//  the auto-zoom keeps its center for dozens of frames until the pixel
+//  spacing needs another limb, so the orbit is only ever extended by the
+//  iterations the cap grew by, and a view at a lower precision reuses the
+//  orbit of the same center held at a higher one
+//  with a directory set every orbit computed is also written there, which
+//  carries the cache over to the next run, orbits too long for memory
+//  spill to `spill_directory`, see OrbitStorage
+class OrbitCache {
+ public:
+  explicit OrbitCache(std::string directory = "",
+                      std::string spill_directory = "")
+      : directory_(std::move(directory)),
+        spill_directory_(std::move(spill_directory)) {}
+
+  //  the orbit of c_re + i c_im at their precision, up to max_iteration,
+  //  whatever has to be iterated for it has its squares spread over `pool`
+  //  a cancelled call returns the orbit as far as it got, and keeps it
+  ReferenceOrbit orbit(const Bignum& c_re, const Bignum& c_im,
+                       const int& max_iteration, ThreadPool* pool = nullptr,
+                       const std::atomic<bool>* cancel = nullptr) {
+    auto entry = std::find_if(
+        entries_.begin(), entries_.end(), [&](const OrbitState& state) {
+          return state.c_re.limbs() >= c_re.limbs() &&
+                 state.c_im.limbs() >= c_im.limbs() && state.c_re == c_re &&
+                 state.c_im == c_im;
+        });
+
+    if (entry == entries_.end()) {
+      OrbitState state;
+      if (!load(c_re, c_im, state))
+        state = start_reference_orbit(c_re, c_im, spill_directory_);
+      entries_.insert(entries_.begin(), std::move(state));
+      if (entries_.size() > ORBIT_CACHE_SIZE) entries_.pop_back();
+    } else {
+      std::rotate(entries_.begin(), entry, entry + 1);
+    }
+
+    OrbitState& state = entries_.front();
+    if (!state.escaped && state.orbit.size() <= max_iteration) {
+      extend_reference_orbit(state, max_iteration, pool, cancel);
+      save(state);
+    }
+
+    //  a longer orbit than asked for is cut at the cap, which is what
+    //  computing it from scratch would have given
+    return state.orbit.prefix(max_iteration + 1);
+  }
+
+ private:
+  //  FNV-1a over the limbs and signs of the center
+  static std::string key(const Bignum& c_re, const Bignum& c_im) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const Bignum* x : {&c_re, &c_im}) {
+      hash = (hash ^ x->negative()) * 1099511628211ull;
+      hash = (hash ^ x->limbs()) * 1099511628211ull;
+      for (int i{}; i < x->limbs(); ++i)
+        hash = (hash ^ x->limb(i)) * 1099511628211ull;
+    }
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx",
+                  static_cast<unsigned long long>(hash));
+    return name;
+  }
+
+  std::filesystem::path path(const Bignum& c_re, const Bignum& c_im) const {
+    return std::filesystem::path(directory_) / (key(c_re, c_im) + ".orbit");
+  }
+
+  template <typename T>
+  static void write(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static bool read(std::istream& in, T& value) {
+    return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  static void write(std::ostream& out, const Bignum& x) {
+    write(out, x.negative());
+    write(out, x.limbs());
+    for (int i{}; i < x.limbs(); ++i) write(out, x.limb(i));
+  }
+
+  static bool read(std::istream& in, Bignum& x) {
+    bool negative;
+    int limbs;
+    if (!read(in, negative) || !read(in, limbs) || limbs < 1) return false;
+    std::vector<Bignum::Limb> digits(limbs);
+    for (auto& limb : digits)
+      if (!read(in, limb)) return false;
+    x = Bignum(std::move(digits), negative);
+    return true;
+  }
+
+  //  the file is written whole and renamed over the old one, so a run that
+  //  is closed halfway through leaves the previous orbit behind
+  void save(const OrbitState& state) const {
+    if (directory_.empty()) return;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    const auto target = path(state.c_re, state.c_im);
+    auto partial = target;
+    partial += ".partial";
+
+    {
+      std::ofstream out(partial, std::ios::binary);
+      if (!out) return;
+      write(out, state.c_re), write(out, state.c_im);
+      write(out, state.re), write(out, state.im);
+      write(out, state.escaped);
+      write(out, state.orbit.size());
+      out.write(reinterpret_cast<const char*>(state.orbit.storage().data()),
+                state.orbit.size() * 2 * sizeof(double));
+      if (!out) return;
+    }
+    std::filesystem::rename(partial, target, error);
+  }
+
+  //  false if there is no file for the center or it holds another one
+  bool load(const Bignum& c_re, const Bignum& c_im, OrbitState& state) const {
+    if (directory_.empty()) return false;
+
+    std::ifstream in(path(c_re, c_im), std::ios::binary);
+    int size;
+    if (!in || !read(in, state.c_re) || !read(in, state.c_im) ||
+        !read(in, state.re) || !read(in, state.im) ||
+        !read(in, state.escaped) || !read(in, size) || size < 1)
+      return false;
+    state.orbit = ReferenceOrbit(spill_directory_);
+    if (state.c_re.limbs() != c_re.limbs() ||
+        state.c_im.limbs() != c_im.limbs() || state.c_re != c_re ||
+        state.c_im != c_im)
+      return false;
+
+    //  in chunks, so an orbit past ORBIT_MEMORY_LIMIT goes straight to its
+    //  mapped file
+    std::vector<double> pairs(2 * std::min<std::size_t>(size, 1 << 16));
+    for (int done{}; done < size;) {
+      const int count = std::min<int>(size - done, pairs.size() / 2);
+      if (!in.read(reinterpret_cast<char*>(pairs.data()),
+                   count * 2 * sizeof(double)))
+        return false;
+      state.orbit.append(pairs.data(), count);
+      done += count;
+    }
+    return true;
+  }
+
+  std::string directory_, spill_directory_;
+  std::vector<OrbitState> entries_;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+//  orbits up to this many iterations are kept in memory, 64 MiB of them
+constexpr std::size_t ORBIT_MEMORY_LIMIT = 1 << 22;
+
+//  Z_n as interleaved (re, im) pairs, so one iteration is one load from one
+//  cache line and page
+//  past ORBIT_MEMORY_LIMIT the pairs move to an unlinked file in
+//  `directory` that is mapped into memory, its pages are written back and
+//  dropped by the kernel under memory pressure instead of being swapped,
+//  and read in again as the pixels stream through the orbit in order, so
+//  orbits of tens of millions of iterations do not have to fit in memory
+//  that only holds for a directory on disk, on a tmpfs such as /tmp often
+//  is the file itself lives in memory and swap
+//  with no directory, or if no file can be mapped, the pairs simply stay
+//  in memory
+class OrbitStorage {
+ public:
+  explicit OrbitStorage(std::string directory = "")
+      : directory_(std::move(directory)) {}
+  OrbitStorage(const OrbitStorage&) = delete;
+  OrbitStorage& operator=(const OrbitStorage&) = delete;
+
+  ~OrbitStorage() {
+    if (mapped_) munmap(mapped_, capacity_ * PAIR_BYTES);
+    if (file_ >= 0) close(file_);
+  }
+
+  std::size_t size() const { return size_; }
+
+  const double* data() const { return mapped_ ? mapped_ : memory_.data(); }
+
+  void push_back(const double& re, const double& im) {
+    if (size_ == capacity_) reserve(std::max<std::size_t>(2 * capacity_, 64));
+    double* pairs = mapped_ ? mapped_ : memory_.data();
+    pairs[2 * size_] = re, pairs[2 * size_ + 1] = im;
+    ++size_;
+  }
+
+  //  n pairs from `pairs`, as read back from a saved orbit
+  void append(const double* pairs, const std::size_t& count) {
+    reserve(size_ + count);
+    double* end = (mapped_ ? mapped_ : memory_.data()) + 2 * size_;
+    std::memcpy(end, pairs, count * PAIR_BYTES);
+    size_ += count;
+  }
+
+  void reserve(const std::size_t& capacity) {
+    if (capacity <= capacity_) return;
+    if (capacity > ORBIT_MEMORY_LIMIT && map(capacity)) return;
+
+    //  in memory, also once a mapped file could not be grown any further
+    if (mapped_) {
+      memory_.assign(mapped_, mapped_ + 2 * size_);
+      munmap(mapped_, capacity_ * PAIR_BYTES);
+      mapped_ = nullptr;
+    }
+    memory_.resize(2 * capacity);
+    capacity_ = capacity;
+  }
+
+ private:
+  static constexpr std::size_t PAIR_BYTES = 2 * sizeof(double);
+
+  //  grows the file and maps it again, the first time the pairs held in
+  //  memory are moved over
+  bool map(const std::size_t& capacity) {
+    if (file_ < 0) {
+      if (directory_.empty()) return false;
+      std::error_code error;
+      std::filesystem::create_directories(directory_, error);
+      std::string path =
+          (std::filesystem::path(directory_) / "orbit-XXXXXX").string();
+      if ((file_ = mkstemp(path.data())) < 0) return false;
+      unlink(path.c_str());
+    }
+    if (ftruncate(file_, capacity * PAIR_BYTES) != 0) return false;
+
+    void* mapping = mmap(nullptr, capacity * PAIR_BYTES, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, file_, 0);
+    if (mapping == MAP_FAILED) return false;
+
+    if (mapped_) {
+      munmap(mapped_, capacity_ * PAIR_BYTES);
+    } else {
+      std::memcpy(mapping, memory_.data(), size_ * PAIR_BYTES);
+      memory_ = {};
+    }
+    mapped_ = static_cast<double*>(mapping);
+    capacity_ = capacity;
+    return true;
+  }
+
+  std::string directory_;
+  std::vector<double> memory_;
+  double* mapped_ = nullptr;
+  int file_ = -1;
+  std::size_t size_ = 0, capacity_ = 0;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <type_traits>
+
+#include "bla.hh"
+#include "escape.hh"
+#include "float_exp.hh"
+#include "reference_orbit.hh"
+#include "series.hh"
+
+//  escape time of c = C + dc, iterating only the delta dz_n = z_n - Z_n:
+//  dz_{n+1} = (2 Z_n + dz_n) dz_n + dc
+//  the first series.skip iterations are replaced by the series, later ones
+//  are skipped in blocks wherever a BLA table entry is valid
+//  a delta that grows past the orbit it is taken from, |Z_n + dz_n| < |dz_n|,
+//  loses its low bits to cancellation in later steps, which shows as the
+//  flat glitch blobs of single reference renders, so the pixel is rebased
+//  onto the start of the reference, dz_0 = z_n, exact since Z_0 = 0, the
+//  same happens once the reference orbit runs out, every pixel stays
+//  correct against the one reference and none has to be re-rendered
+//  D is double, or FloatExp once the deltas would underflow a double, the
+//  series coefficients overflow at those depths so they are double only
+//  with `distance` set dz/dc is followed in units of 1 / spacing, which
+//  keeps it in range at any depth, and the distance estimate in pixels is
+//  stored there
+template <typename D>
+inline int perturbed_escape_time(const ReferenceOrbit& orbit,
+                                 const SeriesApproximation& series,
+                                 const BlaTable& bla, const D& dc_re,
+                                 const D& dc_im, const int& max_iteration,
+                                 const D& spacing, float* distance) {
+  const double bailout = squared(double(ESCAPE_RADIUS));
+  const int last = orbit.size() - 1;
+
+  D dz_re = 0.0, dz_im = 0.0;
+  D der_re = 0.0, der_im = 0.0;
+  int n = 0, iteration = 0;
+  if constexpr (std::is_same_v<D, double>) {
+    const auto start = series.delta({dc_re, dc_im});
+    dz_re = start.real(), dz_im = start.imag();
+    if (distance) {
+      const auto derivative = series.derivative({dc_re, dc_im}) * spacing;
+      der_re = derivative.real(), der_im = derivative.imag();
+    }
+    n = iteration = series.skip;
+  }
+
+  double z_norm = 0;
+  while (iteration < max_iteration) {
+    const double z_re = orbit.re(n) + static_cast<double>(dz_re);
+    const double z_im = orbit.im(n) + static_cast<double>(dz_im);
+    z_norm = squared(z_re) + squared(z_im);
+    if (z_norm >= bailout) break;
+
+    //  rebasing compares in double, a FloatExp delta below its range could
+    //  only outgrow a Z_n that is just as small, which leaves Z_0 = 0
+    const D dz_norm = squared(dz_re) + squared(dz_im);
+    if (n == last || z_norm < static_cast<double>(dz_norm)) {
+      dz_re = D(orbit.re(n)) + dz_re, dz_im = D(orbit.im(n)) + dz_im;
+      n = 0;
+    }
+
+    int length = 0;
+    if (const Bla* step =
+            bla.lookup(n, dz_norm, max_iteration - iteration, length)) {
+      const D a_re = step->a.real(), a_im = step->a.imag();
+      const D b_re = step->b.real(), b_im = step->b.imag();
+      const D curr_re = dz_re;
+      dz_re = a_re * dz_re - a_im * dz_im + b_re * dc_re - b_im * dc_im;
+      dz_im = a_re * dz_im + a_im * curr_re + b_re * dc_im + b_im * dc_re;
+      if (distance) {
+        //  dz/dc = A dz/dc + B
+        const D curr_der_re = der_re;
+        der_re = a_re * der_re - a_im * der_im + b_re * spacing;
+        der_im = a_re * der_im + a_im * curr_der_re + b_im * spacing;
+      }
+      n += length, iteration += length;
+      continue;
+    }
+
+    if (distance) {
+      //  dz/dc = 2 z dz/dc + 1
+      const D two_re = 2 * z_re, two_im = 2 * z_im;
+      const D curr_der_re = der_re;
+      der_re = two_re * der_re - two_im * der_im + spacing;
+      der_im = two_re * der_im + two_im * curr_der_re;
+    }
+
+    const D t_re = D(2 * orbit.re(n)) + dz_re;
+    const D t_im = D(2 * orbit.im(n)) + dz_im;
+    const D curr_re = dz_re;
+    dz_re = t_re * dz_re - t_im * dz_im + dc_re;
+    dz_im = t_re * dz_im + t_im * curr_re + dc_im;
+
+    ++n, ++iteration;
+  }
+
+  if (distance)
+    *distance = iteration < max_iteration
+                    ? distance_estimate(z_norm, static_cast<double>(
+                                                    squared(der_re) +
+                                                    squared(der_im)))
+                    : 0;
+  return iteration;
+}
+
+template <typename D>
+inline void escape_perturbed(const ReferenceOrbit& orbit,
+                             const SeriesApproximation& series,
+                             const BlaTable& bla, const D* dc_re,
+                             const D* dc_im, int count, int max_iteration,
+                             const D& spacing, int* out, float* distance) {
+  for (int i{}; i < count; ++i)
+    out[i] = perturbed_escape_time(orbit, series, bla, dc_re[i], dc_im[i],
+                                   max_iteration, spacing,
+                                   distance ? distance + i : nullptr);
+}
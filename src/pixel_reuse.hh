@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+//  escape times carried over from one frame to the next: `known` marks the
+//  pixels whose escape time, and distance estimate alongside, still belong
+//  to the current view, a frame only iterates the others
+
+//  values of a row-major width x height buffer moved so that pixel (x, y)
+//  takes those of (x + dx, y + dy), pixels shifted in from outside get `fill`
+template <typename T>
+inline void shift_buffer(std::vector<T>& values, const int& dx, const int& dy,
+                         const int& width, const int& height, const T& fill) {
+  std::vector<T> shifted(values.size(), fill);
+  const int x_begin = std::max(0, -dx), x_end = std::min(width, width - dx);
+  for (int y = std::max(0, -dy); y < std::min(height, height - dy); ++y)
+    if (x_begin < x_end)
+      std::copy(values.begin() + (y + dy) * width + x_begin + dx,
+                values.begin() + (y + dy) * width + x_end + dx,
+                shifted.begin() + y * width + x_begin);
+  values.swap(shifted);
+}
+
+//  the view moved by (dx, dy) whole pixels, the pixels still in view keep
+//  their values and only the strips that came into view are unknown
+//  a moved pixel's offset from the new center is rounded apart from its
+//  offset from the old one, so the two points agree to within that rounding
+inline void shift_pixels(const int& dx, const int& dy, const int& width,
+                         const int& height, std::vector<int>& frame,
+                         std::vector<float>& distance,
+                         std::vector<char>& known) {
+  shift_buffer(frame, dx, dy, width, height, 0);
+  shift_buffer(distance, dx, dy, width, height, 0.0f);
+  shift_buffer(known, dx, dy, width, height, char(0));
+}
+
+//  the view zoomed in `factor` times on pixel (x, y), which becomes the
+//  center (width / 2, height / 2): pixel (x', y') is the point of old pixel
+//  (x + (x' - width / 2) / factor, y + (y' - height / 2) / factor), so with
+//  an integer factor the pixels whose offsets from the center divide by it,
+//  1 / factor^2 of them, are points of the old frame and keep their values
+//  distance estimates are in pixels, which are `factor` times smaller now
+inline void zoom_pixels(const int& x, const int& y, const int& factor,
+                        const int& width, const int& height,
+                        std::vector<int>& frame, std::vector<float>& distance,
+                        std::vector<char>& known) {
+  std::vector<int> zoomed_frame(frame.size());
+  std::vector<float> zoomed_distance(distance.size());
+  std::vector<char> zoomed_known(known.size());
+  for (int y_new = (height / 2) % factor; y_new < height; y_new += factor) {
+    const int y_old = y + (y_new - height / 2) / factor;
+    if (y_old < 0 || y_old >= height) continue;
+    for (int x_new = (width / 2) % factor; x_new < width; x_new += factor) {
+      const int x_old = x + (x_new - width / 2) / factor;
+      if (x_old < 0 || x_old >= width) continue;
+      const int from = y_old * width + x_old, to = y_new * width + x_new;
+      zoomed_frame[to] = frame[from];
+      zoomed_distance[to] = distance[from] * factor;
+      zoomed_known[to] = known[from];
+    }
+  }
+  frame.swap(zoomed_frame);
+  distance.swap(zoomed_distance);
+  known.swap(zoomed_known);
+}
+
+//  known escape times counted against a new cap: one that escaped below both
+//  caps is unchanged, one that reaches the new cap is clamped to it, and one
+//  that only reached the old, lower cap has to be iterated again
+inline void change_cap(const int& old_cap, const int& new_cap,
+                       std::vector<int>& frame, std::vector<float>& distance,
+                       std::vector<char>& known) {
+  if (old_cap == new_cap) return;
+  for (std::size_t i{}; i < frame.size(); ++i) {
+    if (!known[i]) continue;
+    if (frame[i] >= new_cap)
+      frame[i] = new_cap, distance[i] = 0;
+    else if (frame[i] >= old_cap)
+      known[i] = false;
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "double_double.hh"
+#include "escape.hh"
+#include "fixed_point.hh"
+#include "simd.hh"
+
+//  scalar types the escape kernels are instantiated for, cheapest first,
+//  perturbation iterates double deltas against a full precision reference
+//  and switches them to FloatExp once they would underflow
+enum class Precision {
+  Float,
+  Double,
+  LongDouble,
+  DoubleDouble,
+  Fixed,
+  Quad,
+  Perturbation,
+  FloatExpPerturbation
+};
+
+//  bits of mantissa kept below one pixel so that rounding, which grows with
+//  every iteration, does not show up as noise
+constexpr int PRECISION_GUARD_BITS = 8;
+
+//  below this spacing the pixel deltas approach the denormal range of a
+//  double, where they would silently lose mantissa bits
+constexpr long double FLOATEXP_SPACING = 1e-280L;
+
+template <typename T>
+constexpr long double epsilon() {
+  return std::numeric_limits<T>::epsilon();
+}
+
+template <>
+constexpr long double epsilon<__float128>() {
+  //  112 explicit mantissa bits
+  return 1.0L / (1ull << 56) / (1ull << 56);
+}
+
+template <>
+constexpr long double epsilon<DoubleDouble>() {
+  //  two 53-bit mantissas
+  return 1.0L / (1ull << 53) / (1ull << 52);
+}
+
+template <typename T>
+inline bool resolves(const long double& spacing,
+                     const long double& magnitude) {
+  return spacing >
+         std::ldexp(epsilon<T>() * magnitude, PRECISION_GUARD_BITS);
+}
+
+//  fixed point resolves absolute rather than relative steps and only holds
+//  views well inside its integer range, and only the escaping step of a
+//  degree 2 formula stays inside it
+inline bool resolves_fixed(const long double& spacing,
+                           const long double& magnitude, const int& power) {
+  return power == 2 && magnitude < ESCAPE_RADIUS &&
+         spacing > std::ldexp(1.0L, PRECISION_GUARD_BITS -
+                                        FixedPoint::FRACTION_BITS);
+}
+
+//  cheapest precision that still separates neighbouring pixels around
+//  coordinates of the given magnitude, past double perturbation is cheaper
+//  than any of the wider scalar types, even vectorized double-double from
+//  1e-15 on, so those only serve the frames perturbation does not apply
+//  to: toggled off with P, Julia sets and formulas other than z^2 + c
+//  vectorized double-double outruns x87 long double over its whole range,
+//  only without AVX2 is long double tried first
+//  `power` is the degree of the formula, perturbation is only asked for
+//  where it applies
+inline Precision select_precision(const long double& spacing,
+                                  const long double& magnitude,
+                                  const int& power, const bool& perturbation) {
+  if (resolves<float>(spacing, magnitude)) return Precision::Float;
+  if (resolves<double>(spacing, magnitude)) return Precision::Double;
+  if (perturbation)
+    return spacing < FLOATEXP_SPACING ? Precision::FloatExpPerturbation
+                                      : Precision::Perturbation;
+  if (simd_backend<Mandelbrot>().dd ==
+          escape_scalar<Mandelbrot, DoubleDouble> &&
+      resolves<long double>(spacing, magnitude))
+    return Precision::LongDouble;
+  if (resolves<DoubleDouble>(spacing, magnitude))
+    return Precision::DoubleDouble;
+  if (resolves_fixed(spacing, magnitude, power)) return Precision::Fixed;
+  return Precision::Quad;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+//  pixel steps of the coarse to fine passes of a brute force frame, 1/16,
+//  then 1/4, then every pixel, each pass only iterates the pixels on its
+//  grid that are not known yet, and a pixel that is not known shows the
+//  sample at the top left corner of its step x step cell
+//  tiles start on multiples of every step, so the cells never cross tiles
+constexpr int PROGRESSIVE_STEPS[] = {4, 2, 1};
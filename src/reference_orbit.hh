@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bignum.hh"
+#include "escape.hh"
+#include "orbit_storage.hh"
+#include "thread_pool.hh"
+
+//  limbs from which the squares of an iteration are spread over the pool,
+//  below this waking the workers costs more than the squares themselves
+constexpr int PARALLEL_SQUARE_LIMBS = 256;
+
+//  orbit Z_n of the reference point, iterated in full precision and rounded
+//  to double afterwards, it ends at the first escaped Z_n or at the cap
+//  copies share their storage, so a cached orbit is handed out as a prefix
+//  without copying it, long orbits spill to `spill_directory`
+class ReferenceOrbit {
+ public:
+  explicit ReferenceOrbit(std::string spill_directory = "")
+      : storage_(std::make_shared<OrbitStorage>(std::move(spill_directory))) {}
+
+  int size() const { return size_; }
+  double re(const int& n) const { return storage_->data()[2 * n]; }
+  double im(const int& n) const { return storage_->data()[2 * n + 1]; }
+
+  //  the first `size` iterations, sharing this orbit's storage
+  ReferenceOrbit prefix(const int& size) const {
+    ReferenceOrbit orbit = *this;
+    orbit.size_ = std::min(size, size_);
+    return orbit;
+  }
+
+  //  only for the orbit that owns the storage, prefixes taken before stay
+  //  valid as they are
+  void push_back(const double& re, const double& im) {
+    storage_->push_back(re, im);
+    size_ = storage_->size();
+  }
+
+  void append(const double* pairs, const int& count) {
+    storage_->append(pairs, count);
+    size_ = storage_->size();
+  }
+
+  void reserve(const int& size) { storage_->reserve(size); }
+
+  const OrbitStorage& storage() const { return *storage_; }
+
+ private:
+  std::shared_ptr<OrbitStorage> storage_;
+  int size_ = 0;
+};
+
+//  fractional limbs needed for the reference at a given pixel spacing, with
+//  a spare limb so the orbit stays exact well below one pixel
+inline int reference_limbs(const long double& spacing) {
+  const int bits = std::max(0, -std::ilogb(spacing)) + 2 * Bignum::LIMB_BITS;
+  return 1 + (bits + Bignum::LIMB_BITS - 1) / Bignum::LIMB_BITS;
+}
+
+//  an orbit together with the full precision Z_n it stopped at, so that a
+//  later frame with a higher cap continues it instead of starting over
+struct OrbitState {
+  Bignum c_re, c_im, re, im;
+  ReferenceOrbit orbit;
+  bool escaped = false;
+};
+
+inline OrbitState start_reference_orbit(
+    const Bignum& c_re, const Bignum& c_im,
+    const std::string& spill_directory = "") {
+  const int limbs = std::max(c_re.limbs(), c_im.limbs());
+  OrbitState state{c_re, c_im, Bignum(limbs), Bignum(limbs),
+                   ReferenceOrbit(spill_directory)};
+  state.orbit.push_back(0, 0);
+  return state;
+}
+
+//  the three squares of an iteration computed together on a pool, each
+//  one's columns cut into ranges of about equal work so that the pool's
+//  threads and the caller all get a share of every square
+class ParallelSquares {
+ public:
+  explicit ParallelSquares(ThreadPool& pool) : pool_(pool) {}
+
+  std::array<Bignum, 3> operator()(const std::array<const Bignum*, 3>& xs) {
+    const int n = std::max({xs[0]->limbs(), xs[1]->limbs(), xs[2]->limbs()});
+    if (n != limbs_) split(n);
+
+    pool_.parallel_for(3 * (bounds_.size() - 1), [&](std::size_t task) {
+      const std::size_t x = task % 3, range = task / 3;
+      Bignum::square_columns(*xs[x], bounds_[range], bounds_[range + 1],
+                             columns_[x].data());
+    });
+
+    return {Bignum::from_square_columns(columns_[0].data(), xs[0]->limbs()),
+            Bignum::from_square_columns(columns_[1].data(), xs[1]->limbs()),
+            Bignum::from_square_columns(columns_[2].data(), xs[2]->limbs())};
+  }
+
+ private:
+  //  column c sums about c / 2 products up to the last kept limb and
+  //  (2 n - c) / 2 past it, one range per thread including the caller
+  void split(const int& n) {
+    limbs_ = n;
+    const int columns = n + Bignum::GUARD_LIMBS;
+    for (auto& sums : columns_) sums.assign(columns, 0);
+
+    std::vector<double> work(columns + 1);
+    for (int c{}; c < columns; ++c)
+      work[c + 1] = work[c] + 1 + std::min(c + 1, 2 * n - 1 - c) / 2.0;
+
+    const std::size_t ranges = pool_.size() + 1;
+    bounds_.assign(1, 0);
+    for (std::size_t k = 1; k < ranges; ++k) {
+      int c = bounds_.back();
+      while (c < columns && work[c] < work[columns] * k / ranges) ++c;
+      bounds_.push_back(c);
+    }
+    bounds_.push_back(columns);
+  }
+
+  ThreadPool& pool_;
+  int limbs_ = 0;
+  std::vector<int> bounds_;
+  std::array<std::vector<unsigned __int128>, 3> columns_;
+};
+
+//  iterates until Z_n escapes or n reaches max_iteration, a lower cap than
+//  the orbit already has leaves it as it is
+//  with a pool the squares of precise enough orbits are spread over it,
+//  the iterations themselves depend on each other and stay in order
+//  once `cancel` is set it returns early, the state is a shorter but
+//  valid orbit that a later call picks up from
+inline void extend_reference_orbit(OrbitState& state, const int& max_iteration,
+                                   ThreadPool* pool = nullptr,
+                                   const std::atomic<bool>* cancel = nullptr) {
+  const long double bailout = squared(ESCAPE_RADIUS);
+  ReferenceOrbit& orbit = state.orbit;
+  orbit.reserve(max_iteration + 1);
+
+  Bignum &re = state.re, &im = state.im;
+  const bool parallel =
+      pool && pool->size() > 1 && re.limbs() >= PARALLEL_SQUARE_LIMBS;
+  std::unique_ptr<ParallelSquares> parallel_squares;
+  if (parallel) parallel_squares = std::make_unique<ParallelSquares>(*pool);
+
+  while (!state.escaped && orbit.size() <= max_iteration) {
+    if (cancel && cancel->load(std::memory_order_relaxed)) return;
+
+    //  z = z^2 + c, with 2 re im = (re + im)^2 - re^2 - im^2 so that every
+    //  product is a cheaper square
+    if (parallel) {
+      const Bignum sum = re + im;
+      const auto [re_2, im_2, sum_2] = (*parallel_squares)({&re, &im, &sum});
+      im = sum_2 - re_2 - im_2 + state.c_im;
+      re = re_2 - im_2 + state.c_re;
+    } else {
+      const Bignum re_2 = squared(re), im_2 = squared(im);
+      im = squared(re + im) - re_2 - im_2 + state.c_im;
+      re = re_2 - im_2 + state.c_re;
+    }
+
+    const double z_re = static_cast<double>(re), z_im = static_cast<double>(im);
+    orbit.push_back(z_re, z_im);
+    state.escaped = squared(z_re) + squared(z_im) >= bailout;
+  }
+}
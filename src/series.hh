@@ -0,0 +1,68 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "escape.hh"
+#include "reference_orbit.hh"
+
+//  a probe's series error has to stay below this fraction of its delta, a
+//  few thousand roundings of a double, the perturbed iterations after the
+//  skip amplify whatever error the delta starts with on chaotic pixels
+constexpr double SERIES_TOLERANCE = 1e-12;
+
+//  dz_n ~ A_n dc + B_n dc^2 + C_n dc^3 around the reference orbit, valid up
+//  to iteration `skip` for every dc inside the probed view
+struct SeriesApproximation {
+  int skip = 0;
+  std::complex<double> a, b, c;
+
+  std::complex<double> delta(const std::complex<double>& dc) const {
+    return ((c * dc + b) * dc + a) * dc;
+  }
+
+  //  d delta / d dc
+  std::complex<double> derivative(const std::complex<double>& dc) const {
+    return (3.0 * c * dc + 2.0 * b) * dc + a;
+  }
+};
+
+//  advances the coefficients alongside exact perturbed orbits of the probe
+//  points and stops at the first iteration where any of them disagrees
+inline SeriesApproximation approximate_series(
+    const ReferenceOrbit& orbit,
+    const std::vector<std::complex<double>>& probes,
+    const int& max_iteration) {
+  const double bailout = squared(double(ESCAPE_RADIUS));
+  const int last = std::min(orbit.size() - 1, max_iteration);
+
+  SeriesApproximation series;
+  std::complex<double> a, b, c;
+  std::vector<std::complex<double>> deltas(probes.size());
+
+  for (int n{}; n < last; ++n) {
+    const std::complex<double> z(orbit.re(n), orbit.im(n));
+    const std::complex<double> z_next(orbit.re(n + 1), orbit.im(n + 1));
+
+    //  A' = 2ZA + 1, B' = 2ZB + A^2, C' = 2ZC + 2AB
+    const std::complex<double> next_c = 2.0 * (z * c + a * b);
+    const std::complex<double> next_b = 2.0 * z * b + a * a;
+    const std::complex<double> next_a = 2.0 * z * a + 1.0;
+    a = next_a, b = next_b, c = next_c;
+    const SeriesApproximation candidate{n + 1, a, b, c};
+
+    for (std::size_t k{}; k < probes.size(); ++k) {
+      auto& dz = deltas[k];
+      dz = (2.0 * z + dz) * dz + probes[k];
+
+      if (std::norm(z_next + dz) >= bailout) return series;
+      if (std::abs(candidate.delta(probes[k]) - dz) >
+          SERIES_TOLERANCE * std::abs(dz))
+        return series;
+    }
+
+    series = candidate;
+  }
+
+  return series;
+}
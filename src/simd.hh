@@ -0,0 +1,675 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "double_double.hh"
+#include "escape.hh"
+
+//  escape times for `count` independent points (re[i], im[i]), orbits that
+//  return within `tolerance` of a checkpoint are interior, every kernel is
+//  instantiated per formula
+template <typename T>
+using EscapeKernel = void (*)(const T* re, const T* im, int count,
+                              int max_iteration, double tolerance,
+                              const Seed& seed, int* out);
+
+template <typename Formula, typename T>
+inline void escape_scalar(const T* re, const T* im, int count,
+                          int max_iteration, double tolerance,
+                          const Seed& seed, int* out) {
+  for (int i{}; i < count; ++i)
+    out[i] = escape_time<Formula>(re[i], im[i], max_iteration, tolerance, seed);
+}
+
+//  escape times together with distance estimates in pixels of `spacing`,
+//  scalar only since following dz/dc doubles the work of every iteration
+template <typename Formula, typename T>
+inline void escape_distance(const T* re, const T* im, int count,
+                            int max_iteration, double spacing,
+                            const Seed& seed, int* out, float* distance) {
+  for (int i{}; i < count; ++i) {
+    double estimate;
+    out[i] = escape_time<Formula>(re[i], im[i], max_iteration,
+                                  PERIOD_TOLERANCE * spacing, seed, &estimate);
+    distance[i] = estimate / spacing;
+  }
+}
+
+//  every lane keeps iterating until all of them escaped or hit the cap,
+//  a lane only counts iterations while its escape mask is still set, lanes
+//  inside the main cardioid or period-2 bulb start out finished at the cap
+//  and lanes caught by the shared Brent checkpoint jump to it
+//  a Julia seed swaps the roles of the pixel and c, which only changes how
+//  a batch starts, the loop itself is the same for both
+
+template <typename Formula>
+__attribute__((target("avx2,fma"), flatten)) inline void escape_avx2_f64(
+    const double* re, const double* im, int count, int max_iteration,
+    double tolerance, const Seed& seed, int* out) {
+  const __m256d bailout = _mm256_set1_pd(squared(double(ESCAPE_RADIUS)));
+  const __m256d tolerance_2 = _mm256_set1_pd(squared(tolerance));
+  const __m256i cap = _mm256_set1_epi64x(max_iteration);
+  const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+
+  for (int i{}; i < count; i += 4) {
+    const __m256i tail =
+        _mm256_cmpgt_epi64(_mm256_set1_epi64x(count - i), lane);
+    const __m256d pixel_re = _mm256_maskload_pd(re + i, tail);
+    const __m256d pixel_im = _mm256_maskload_pd(im + i, tail);
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __m256i eligible =
+        Formula::quadratic && !seed.julia ? tail : _mm256_setzero_si256();
+    const __m256d pixel_im_2 = _mm256_mul_pd(pixel_im, pixel_im);
+    const __m256d x = _mm256_sub_pd(pixel_re, _mm256_set1_pd(0.25));
+    const __m256d q = _mm256_fmadd_pd(x, x, pixel_im_2);
+    const __m256d bulb = _mm256_add_pd(pixel_re, _mm256_set1_pd(1));
+    const __m256d interior = _mm256_and_pd(
+        _mm256_castsi256_pd(eligible),
+        _mm256_or_pd(
+            _mm256_cmp_pd(_mm256_mul_pd(q, _mm256_add_pd(q, x)),
+                          _mm256_mul_pd(_mm256_set1_pd(0.25), pixel_im_2),
+                          _CMP_LE_OQ),
+            _mm256_cmp_pd(_mm256_fmadd_pd(bulb, bulb, pixel_im_2),
+                          _mm256_set1_pd(0.0625), _CMP_LE_OQ)));
+
+    const __m256d c_re = seed.julia ? _mm256_set1_pd(seed.re) : pixel_re;
+    const __m256d c_im = seed.julia ? _mm256_set1_pd(seed.im) : pixel_im;
+    __m256d z_re = seed.julia ? pixel_re : _mm256_setzero_pd();
+    __m256d z_im = seed.julia ? pixel_im : _mm256_setzero_pd();
+    __m256d active = _mm256_andnot_pd(interior, _mm256_castsi256_pd(tail));
+    __m256i iterations =
+        _mm256_and_si256(_mm256_castpd_si256(interior), cap);
+    __m256d check_re = z_re, check_im = z_im;
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      const __m256d re_2 = _mm256_mul_pd(z_re, z_re);
+      const __m256d im_2 = _mm256_mul_pd(z_im, z_im);
+      active = _mm256_and_pd(
+          active,
+          _mm256_cmp_pd(_mm256_add_pd(re_2, im_2), bailout, _CMP_LT_OQ));
+      if (_mm256_movemask_pd(active) == 0) break;
+
+      //  the mask is all ones (-1) in active lanes
+      iterations = _mm256_sub_epi64(iterations, _mm256_castpd_si256(active));
+
+      //  z = f(z) + c, the formula's own squares of z fold into re_2 and
+      //  im_2
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      const __m256d d_re = _mm256_sub_pd(z_re, check_re);
+      const __m256d d_im = _mm256_sub_pd(z_im, check_im);
+      const __m256d periodic = _mm256_and_pd(
+          active, _mm256_cmp_pd(_mm256_fmadd_pd(d_re, d_re,
+                                                _mm256_mul_pd(d_im, d_im)),
+                                tolerance_2, _CMP_LT_OQ));
+      iterations = _mm256_blendv_epi8(iterations, cap,
+                                      _mm256_castpd_si256(periodic));
+      active = _mm256_andnot_pd(periodic, active);
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(32) std::int64_t result[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(result), iterations);
+    for (int k{}; k < std::min(4, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+template <typename Formula>
+__attribute__((target("avx2,fma"), flatten)) inline void escape_avx2_f32(
+    const float* re, const float* im, int count, int max_iteration,
+    double tolerance, const Seed& seed, int* out) {
+  const __m256 bailout = _mm256_set1_ps(squared(float(ESCAPE_RADIUS)));
+  const __m256 tolerance_2 = _mm256_set1_ps(squared(tolerance));
+  const __m256i cap = _mm256_set1_epi32(max_iteration);
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  for (int i{}; i < count; i += 8) {
+    const __m256i tail =
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lane);
+    const __m256 pixel_re = _mm256_maskload_ps(re + i, tail);
+    const __m256 pixel_im = _mm256_maskload_ps(im + i, tail);
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __m256i eligible =
+        Formula::quadratic && !seed.julia ? tail : _mm256_setzero_si256();
+    const __m256 pixel_im_2 = _mm256_mul_ps(pixel_im, pixel_im);
+    const __m256 x = _mm256_sub_ps(pixel_re, _mm256_set1_ps(0.25f));
+    const __m256 q = _mm256_fmadd_ps(x, x, pixel_im_2);
+    const __m256 bulb = _mm256_add_ps(pixel_re, _mm256_set1_ps(1));
+    const __m256 interior = _mm256_and_ps(
+        _mm256_castsi256_ps(eligible),
+        _mm256_or_ps(
+            _mm256_cmp_ps(_mm256_mul_ps(q, _mm256_add_ps(q, x)),
+                          _mm256_mul_ps(_mm256_set1_ps(0.25f), pixel_im_2),
+                          _CMP_LE_OQ),
+            _mm256_cmp_ps(_mm256_fmadd_ps(bulb, bulb, pixel_im_2),
+                          _mm256_set1_ps(0.0625f), _CMP_LE_OQ)));
+
+    const __m256 c_re = seed.julia ? _mm256_set1_ps(seed.re) : pixel_re;
+    const __m256 c_im = seed.julia ? _mm256_set1_ps(seed.im) : pixel_im;
+    __m256 z_re = seed.julia ? pixel_re : _mm256_setzero_ps();
+    __m256 z_im = seed.julia ? pixel_im : _mm256_setzero_ps();
+    __m256 active = _mm256_andnot_ps(interior, _mm256_castsi256_ps(tail));
+    __m256i iterations =
+        _mm256_and_si256(_mm256_castps_si256(interior), cap);
+    __m256 check_re = z_re, check_im = z_im;
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      const __m256 re_2 = _mm256_mul_ps(z_re, z_re);
+      const __m256 im_2 = _mm256_mul_ps(z_im, z_im);
+      active = _mm256_and_ps(
+          active,
+          _mm256_cmp_ps(_mm256_add_ps(re_2, im_2), bailout, _CMP_LT_OQ));
+      if (_mm256_movemask_ps(active) == 0) break;
+
+      iterations = _mm256_sub_epi32(iterations, _mm256_castps_si256(active));
+
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      const __m256 d_re = _mm256_sub_ps(z_re, check_re);
+      const __m256 d_im = _mm256_sub_ps(z_im, check_im);
+      const __m256 periodic = _mm256_and_ps(
+          active, _mm256_cmp_ps(_mm256_fmadd_ps(d_re, d_re,
+                                                _mm256_mul_ps(d_im, d_im)),
+                                tolerance_2, _CMP_LT_OQ));
+      iterations = _mm256_blendv_epi8(iterations, cap,
+                                      _mm256_castps_si256(periodic));
+      active = _mm256_andnot_ps(periodic, active);
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(32) std::int32_t result[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(result), iterations);
+    for (int k{}; k < std::min(8, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+template <typename Formula>
+__attribute__((target("avx512f"), flatten)) inline void escape_avx512_f64(
+    const double* re, const double* im, int count, int max_iteration,
+    double tolerance, const Seed& seed, int* out) {
+  const __m512d bailout = _mm512_set1_pd(squared(double(ESCAPE_RADIUS)));
+  const __m512d tolerance_2 = _mm512_set1_pd(squared(tolerance));
+  const __m512i cap = _mm512_set1_epi64(max_iteration);
+  const __m512i one = _mm512_set1_epi64(1);
+
+  for (int i{}; i < count; i += 8) {
+    const __mmask8 tail = count - i >= 8 ? 0xff : (1u << (count - i)) - 1;
+    const __m512d pixel_re = _mm512_maskz_loadu_pd(tail, re + i);
+    const __m512d pixel_im = _mm512_maskz_loadu_pd(tail, im + i);
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __mmask8 eligible = Formula::quadratic && !seed.julia ? tail : 0;
+    const __m512d pixel_im_2 = _mm512_mul_pd(pixel_im, pixel_im);
+    const __m512d x = _mm512_sub_pd(pixel_re, _mm512_set1_pd(0.25));
+    const __m512d q = _mm512_fmadd_pd(x, x, pixel_im_2);
+    const __m512d bulb = _mm512_add_pd(pixel_re, _mm512_set1_pd(1));
+    const __mmask8 interior =
+        _mm512_mask_cmp_pd_mask(
+            eligible, _mm512_mul_pd(q, _mm512_add_pd(q, x)),
+            _mm512_mul_pd(_mm512_set1_pd(0.25), pixel_im_2), _CMP_LE_OQ) |
+        _mm512_mask_cmp_pd_mask(eligible,
+                                _mm512_fmadd_pd(bulb, bulb, pixel_im_2),
+                                _mm512_set1_pd(0.0625), _CMP_LE_OQ);
+
+    const __m512d c_re = seed.julia ? _mm512_set1_pd(seed.re) : pixel_re;
+    const __m512d c_im = seed.julia ? _mm512_set1_pd(seed.im) : pixel_im;
+    __m512d z_re = seed.julia ? pixel_re : _mm512_setzero_pd();
+    __m512d z_im = seed.julia ? pixel_im : _mm512_setzero_pd();
+    __mmask8 active = tail & ~interior;
+    __m512i iterations = _mm512_maskz_mov_epi64(interior, cap);
+    __m512d check_re = z_re, check_im = z_im;
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      const __m512d re_2 = _mm512_mul_pd(z_re, z_re);
+      const __m512d im_2 = _mm512_mul_pd(z_im, z_im);
+      active = _mm512_mask_cmp_pd_mask(active, _mm512_add_pd(re_2, im_2),
+                                       bailout, _CMP_LT_OQ);
+      if (active == 0) break;
+
+      iterations = _mm512_mask_add_epi64(iterations, active, iterations, one);
+
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      const __m512d d_re = _mm512_sub_pd(z_re, check_re);
+      const __m512d d_im = _mm512_sub_pd(z_im, check_im);
+      const __mmask8 periodic = _mm512_mask_cmp_pd_mask(
+          active, _mm512_fmadd_pd(d_re, d_re, _mm512_mul_pd(d_im, d_im)),
+          tolerance_2, _CMP_LT_OQ);
+      iterations = _mm512_mask_mov_epi64(iterations, periodic, cap);
+      active &= ~periodic;
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(64) std::int64_t result[8];
+    _mm512_store_si512(result, iterations);
+    for (int k{}; k < std::min(8, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+template <typename Formula>
+__attribute__((target("avx512f"), flatten)) inline void escape_avx512_f32(
+    const float* re, const float* im, int count, int max_iteration,
+    double tolerance, const Seed& seed, int* out) {
+  const __m512 bailout = _mm512_set1_ps(squared(float(ESCAPE_RADIUS)));
+  const __m512 tolerance_2 = _mm512_set1_ps(squared(tolerance));
+  const __m512i cap = _mm512_set1_epi32(max_iteration);
+  const __m512i one = _mm512_set1_epi32(1);
+
+  for (int i{}; i < count; i += 16) {
+    const __mmask16 tail =
+        count - i >= 16 ? 0xffff : (1u << (count - i)) - 1;
+    const __m512 pixel_re = _mm512_maskz_loadu_ps(tail, re + i);
+    const __m512 pixel_im = _mm512_maskz_loadu_ps(tail, im + i);
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __mmask16 eligible = Formula::quadratic && !seed.julia ? tail : 0;
+    const __m512 pixel_im_2 = _mm512_mul_ps(pixel_im, pixel_im);
+    const __m512 x = _mm512_sub_ps(pixel_re, _mm512_set1_ps(0.25f));
+    const __m512 q = _mm512_fmadd_ps(x, x, pixel_im_2);
+    const __m512 bulb = _mm512_add_ps(pixel_re, _mm512_set1_ps(1));
+    const __mmask16 interior =
+        _mm512_mask_cmp_ps_mask(
+            eligible, _mm512_mul_ps(q, _mm512_add_ps(q, x)),
+            _mm512_mul_ps(_mm512_set1_ps(0.25f), pixel_im_2), _CMP_LE_OQ) |
+        _mm512_mask_cmp_ps_mask(eligible,
+                                _mm512_fmadd_ps(bulb, bulb, pixel_im_2),
+                                _mm512_set1_ps(0.0625f), _CMP_LE_OQ);
+
+    const __m512 c_re = seed.julia ? _mm512_set1_ps(seed.re) : pixel_re;
+    const __m512 c_im = seed.julia ? _mm512_set1_ps(seed.im) : pixel_im;
+    __m512 z_re = seed.julia ? pixel_re : _mm512_setzero_ps();
+    __m512 z_im = seed.julia ? pixel_im : _mm512_setzero_ps();
+    __mmask16 active = tail & ~interior;
+    __m512i iterations = _mm512_maskz_mov_epi32(interior, cap);
+    __m512 check_re = z_re, check_im = z_im;
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      const __m512 re_2 = _mm512_mul_ps(z_re, z_re);
+      const __m512 im_2 = _mm512_mul_ps(z_im, z_im);
+      active = _mm512_mask_cmp_ps_mask(active, _mm512_add_ps(re_2, im_2),
+                                       bailout, _CMP_LT_OQ);
+      if (active == 0) break;
+
+      iterations = _mm512_mask_add_epi32(iterations, active, iterations, one);
+
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      const __m512 d_re = _mm512_sub_ps(z_re, check_re);
+      const __m512 d_im = _mm512_sub_ps(z_im, check_im);
+      const __mmask16 periodic = _mm512_mask_cmp_ps_mask(
+          active, _mm512_fmadd_ps(d_re, d_re, _mm512_mul_ps(d_im, d_im)),
+          tolerance_2, _CMP_LT_OQ);
+      iterations = _mm512_mask_mov_epi32(iterations, periodic, cap);
+      active &= ~periodic;
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(64) std::int32_t result[16];
+    _mm512_store_si512(result, iterations);
+    for (int k{}; k < std::min(16, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+//  double-double lanes: the hi and lo parts of four or eight numbers in two
+//  registers, operations are the ones of DoubleDouble done lane-wise
+
+struct DoubleDouble256 {
+  __m256d hi, lo;
+};
+
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 quick_two_sum(
+    const __m256d& a, const __m256d& b) {
+  const __m256d s = _mm256_add_pd(a, b);
+  return {s, _mm256_sub_pd(b, _mm256_sub_pd(s, a))};
+}
+
+__attribute__((target("avx2,fma"))) inline __m256d two_sum(const __m256d& a,
+                                                            const __m256d& b,
+                                                            __m256d& e) {
+  const __m256d s = _mm256_add_pd(a, b);
+  const __m256d v = _mm256_sub_pd(s, a);
+  e = _mm256_add_pd(_mm256_sub_pd(a, _mm256_sub_pd(s, v)),
+                    _mm256_sub_pd(b, v));
+  return s;
+}
+
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 operator+(
+    const DoubleDouble256& a, const DoubleDouble256& b) {
+  __m256d e, f;
+  const __m256d s = two_sum(a.hi, b.hi, e);
+  const __m256d t = two_sum(a.lo, b.lo, f);
+  const DoubleDouble256 u = quick_two_sum(s, _mm256_add_pd(e, t));
+  return quick_two_sum(u.hi, _mm256_add_pd(u.lo, f));
+}
+
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 operator-(
+    const DoubleDouble256& a, const DoubleDouble256& b) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  return a + DoubleDouble256{_mm256_xor_pd(b.hi, sign),
+                             _mm256_xor_pd(b.lo, sign)};
+}
+
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 operator*(
+    const DoubleDouble256& a, const DoubleDouble256& b) {
+  const __m256d p = _mm256_mul_pd(a.hi, b.hi);
+  const __m256d e = _mm256_fmsub_pd(a.hi, b.hi, p);
+  return quick_two_sum(
+      p, _mm256_fmadd_pd(a.hi, b.lo, _mm256_fmadd_pd(a.lo, b.hi, e)));
+}
+
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 squared(
+    const DoubleDouble256& x) {
+  const __m256d p = _mm256_mul_pd(x.hi, x.hi);
+  const __m256d e = _mm256_fmsub_pd(x.hi, x.hi, p);
+  return quick_two_sum(p,
+                       _mm256_fmadd_pd(_mm256_add_pd(x.hi, x.hi), x.lo, e));
+}
+
+//  exact, as scaling by a power of two never rounds
+__attribute__((target("avx2,fma"))) inline DoubleDouble256 scaled(
+    const DoubleDouble256& x, const double& factor) {
+  const __m256d f = _mm256_set1_pd(factor);
+  return {_mm256_mul_pd(x.hi, f), _mm256_mul_pd(x.lo, f)};
+}
+
+__attribute__((target("avx2,fma"))) inline void make_absolute(
+    DoubleDouble256& x) {
+  //  the sign of the number is the sign of hi
+  const __m256d sign = _mm256_and_pd(x.hi, _mm256_set1_pd(-0.0));
+  x = {_mm256_xor_pd(x.hi, sign), _mm256_xor_pd(x.lo, sign)};
+}
+
+//  all ones in the lanes where a <= b
+__attribute__((target("avx2,fma"))) inline __m256d less_equal(
+    const DoubleDouble256& a, const DoubleDouble256& b) {
+  return _mm256_or_pd(
+      _mm256_cmp_pd(a.hi, b.hi, _CMP_LT_OQ),
+      _mm256_and_pd(_mm256_cmp_pd(a.hi, b.hi, _CMP_EQ_OQ),
+                    _mm256_cmp_pd(a.lo, b.lo, _CMP_LE_OQ)));
+}
+
+template <typename Formula>
+__attribute__((target("avx2,fma"), flatten)) inline void escape_avx2_dd(
+    const DoubleDouble* re, const DoubleDouble* im, int count,
+    int max_iteration, double tolerance, const Seed& seed, int* out) {
+  const __m256d bailout = _mm256_set1_pd(squared(double(ESCAPE_RADIUS)));
+  const __m256d tolerance_2 = _mm256_set1_pd(squared(tolerance));
+  const __m256i cap = _mm256_set1_epi64x(max_iteration);
+  const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+  const DoubleDouble256 quarter{_mm256_set1_pd(0.25), _mm256_setzero_pd()};
+  const DoubleDouble256 one{_mm256_set1_pd(1), _mm256_setzero_pd()};
+  const DoubleDouble256 bulb_radius_2{_mm256_set1_pd(0.0625),
+                                      _mm256_setzero_pd()};
+
+  for (int i{}; i < count; i += 4) {
+    const __m256i tail =
+        _mm256_cmpgt_epi64(_mm256_set1_epi64x(count - i), lane);
+
+    alignas(32) double re_hi[4]{}, re_lo[4]{}, im_hi[4]{}, im_lo[4]{};
+    for (int k{}; k < std::min(4, count - i); ++k) {
+      re_hi[k] = re[i + k].hi(), re_lo[k] = re[i + k].lo();
+      im_hi[k] = im[i + k].hi(), im_lo[k] = im[i + k].lo();
+    }
+    const DoubleDouble256 pixel_re{_mm256_load_pd(re_hi),
+                                    _mm256_load_pd(re_lo)};
+    const DoubleDouble256 pixel_im{_mm256_load_pd(im_hi),
+                                    _mm256_load_pd(im_lo)};
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __m256i eligible =
+        Formula::quadratic && !seed.julia ? tail : _mm256_setzero_si256();
+    //  the interior test needs the full precision too, a view this deep
+    //  may straddle the cardioid boundary
+    const DoubleDouble256 pixel_im_2 = squared(pixel_im);
+    const DoubleDouble256 x = pixel_re - quarter;
+    const DoubleDouble256 q = squared(x) + pixel_im_2;
+    const __m256d interior = _mm256_and_pd(
+        _mm256_castsi256_pd(eligible),
+        _mm256_or_pd(less_equal(q * (q + x), scaled(pixel_im_2, 0.25)),
+                     less_equal(squared(pixel_re + one) + pixel_im_2,
+                                bulb_radius_2)));
+
+    const DoubleDouble256 z{_mm256_setzero_pd(), _mm256_setzero_pd()};
+    const DoubleDouble256 c_re =
+        seed.julia ? DoubleDouble256{_mm256_set1_pd(seed.re), z.lo} : pixel_re;
+    const DoubleDouble256 c_im =
+        seed.julia ? DoubleDouble256{_mm256_set1_pd(seed.im), z.lo} : pixel_im;
+    DoubleDouble256 z_re = seed.julia ? pixel_re : z;
+    DoubleDouble256 z_im = seed.julia ? pixel_im : z;
+    DoubleDouble256 check_re = z_re, check_im = z_im;
+    __m256d active = _mm256_andnot_pd(interior, _mm256_castsi256_pd(tail));
+    __m256i iterations =
+        _mm256_and_si256(_mm256_castpd_si256(interior), cap);
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      //  the leading parts are plenty to tell an escaped orbit
+      const __m256d norm = _mm256_fmadd_pd(
+          z_re.hi, z_re.hi, _mm256_mul_pd(z_im.hi, z_im.hi));
+      active = _mm256_and_pd(active,
+                             _mm256_cmp_pd(norm, bailout, _CMP_LT_OQ));
+      if (_mm256_movemask_pd(active) == 0) break;
+
+      iterations = _mm256_sub_epi64(iterations, _mm256_castpd_si256(active));
+
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      //  the tolerance is far below a pixel, so only the leading parts of
+      //  the exact differences are compared
+      const __m256d d_re = (z_re - check_re).hi;
+      const __m256d d_im = (z_im - check_im).hi;
+      const __m256d periodic = _mm256_and_pd(
+          active, _mm256_cmp_pd(_mm256_fmadd_pd(d_re, d_re,
+                                                _mm256_mul_pd(d_im, d_im)),
+                                tolerance_2, _CMP_LT_OQ));
+      iterations = _mm256_blendv_epi8(iterations, cap,
+                                      _mm256_castpd_si256(periodic));
+      active = _mm256_andnot_pd(periodic, active);
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(32) std::int64_t result[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(result), iterations);
+    for (int k{}; k < std::min(4, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+struct DoubleDouble512 {
+  __m512d hi, lo;
+};
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 quick_two_sum(
+    const __m512d& a, const __m512d& b) {
+  const __m512d s = _mm512_add_pd(a, b);
+  return {s, _mm512_sub_pd(b, _mm512_sub_pd(s, a))};
+}
+
+__attribute__((target("avx512f"))) inline __m512d two_sum(const __m512d& a,
+                                                           const __m512d& b,
+                                                           __m512d& e) {
+  const __m512d s = _mm512_add_pd(a, b);
+  const __m512d v = _mm512_sub_pd(s, a);
+  e = _mm512_add_pd(_mm512_sub_pd(a, _mm512_sub_pd(s, v)),
+                    _mm512_sub_pd(b, v));
+  return s;
+}
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 operator+(
+    const DoubleDouble512& a, const DoubleDouble512& b) {
+  __m512d e, f;
+  const __m512d s = two_sum(a.hi, b.hi, e);
+  const __m512d t = two_sum(a.lo, b.lo, f);
+  const DoubleDouble512 u = quick_two_sum(s, _mm512_add_pd(e, t));
+  return quick_two_sum(u.hi, _mm512_add_pd(u.lo, f));
+}
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 operator-(
+    const DoubleDouble512& a, const DoubleDouble512& b) {
+  const __m512d zero = _mm512_setzero_pd();
+  return a + DoubleDouble512{_mm512_sub_pd(zero, b.hi),
+                             _mm512_sub_pd(zero, b.lo)};
+}
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 operator*(
+    const DoubleDouble512& a, const DoubleDouble512& b) {
+  const __m512d p = _mm512_mul_pd(a.hi, b.hi);
+  const __m512d e = _mm512_fmsub_pd(a.hi, b.hi, p);
+  return quick_two_sum(
+      p, _mm512_fmadd_pd(a.hi, b.lo, _mm512_fmadd_pd(a.lo, b.hi, e)));
+}
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 squared(
+    const DoubleDouble512& x) {
+  const __m512d p = _mm512_mul_pd(x.hi, x.hi);
+  const __m512d e = _mm512_fmsub_pd(x.hi, x.hi, p);
+  return quick_two_sum(p,
+                       _mm512_fmadd_pd(_mm512_add_pd(x.hi, x.hi), x.lo, e));
+}
+
+__attribute__((target("avx512f"))) inline DoubleDouble512 scaled(
+    const DoubleDouble512& x, const double& factor) {
+  const __m512d f = _mm512_set1_pd(factor);
+  return {_mm512_mul_pd(x.hi, f), _mm512_mul_pd(x.lo, f)};
+}
+
+__attribute__((target("avx512f"))) inline void make_absolute(
+    DoubleDouble512& x) {
+  const __m512d zero = _mm512_setzero_pd();
+  const __mmask8 negative = _mm512_cmp_pd_mask(x.hi, zero, _CMP_LT_OQ);
+  x = {_mm512_mask_sub_pd(x.hi, negative, zero, x.hi),
+       _mm512_mask_sub_pd(x.lo, negative, zero, x.lo)};
+}
+
+__attribute__((target("avx512f"))) inline __mmask8 less_equal(
+    const __mmask8& mask, const DoubleDouble512& a, const DoubleDouble512& b) {
+  return _mm512_mask_cmp_pd_mask(mask, a.hi, b.hi, _CMP_LT_OQ) |
+         (_mm512_mask_cmp_pd_mask(mask, a.hi, b.hi, _CMP_EQ_OQ) &
+          _mm512_mask_cmp_pd_mask(mask, a.lo, b.lo, _CMP_LE_OQ));
+}
+
+template <typename Formula>
+__attribute__((target("avx512f"), flatten)) inline void escape_avx512_dd(
+    const DoubleDouble* re, const DoubleDouble* im, int count,
+    int max_iteration, double tolerance, const Seed& seed, int* out) {
+  const __m512d bailout = _mm512_set1_pd(squared(double(ESCAPE_RADIUS)));
+  const __m512d tolerance_2 = _mm512_set1_pd(squared(tolerance));
+  const __m512i cap = _mm512_set1_epi64(max_iteration);
+  const __m512i one = _mm512_set1_epi64(1);
+  const DoubleDouble512 quarter{_mm512_set1_pd(0.25), _mm512_setzero_pd()};
+  const DoubleDouble512 unit{_mm512_set1_pd(1), _mm512_setzero_pd()};
+  const DoubleDouble512 bulb_radius_2{_mm512_set1_pd(0.0625),
+                                      _mm512_setzero_pd()};
+
+  for (int i{}; i < count; i += 8) {
+    const __mmask8 tail = count - i >= 8 ? 0xff : (1u << (count - i)) - 1;
+
+    alignas(64) double re_hi[8]{}, re_lo[8]{}, im_hi[8]{}, im_lo[8]{};
+    for (int k{}; k < std::min(8, count - i); ++k) {
+      re_hi[k] = re[i + k].hi(), re_lo[k] = re[i + k].lo();
+      im_hi[k] = im[i + k].hi(), im_lo[k] = im[i + k].lo();
+    }
+    const DoubleDouble512 pixel_re{_mm512_load_pd(re_hi),
+                                    _mm512_load_pd(re_lo)};
+    const DoubleDouble512 pixel_im{_mm512_load_pd(im_hi),
+                                    _mm512_load_pd(im_lo)};
+
+    //  the closed-form test only holds for the Mandelbrot set itself
+    const __mmask8 eligible = Formula::quadratic && !seed.julia ? tail : 0;
+    const DoubleDouble512 pixel_im_2 = squared(pixel_im);
+    const DoubleDouble512 x = pixel_re - quarter;
+    const DoubleDouble512 q = squared(x) + pixel_im_2;
+    const __mmask8 interior =
+        less_equal(eligible, q * (q + x), scaled(pixel_im_2, 0.25)) |
+        less_equal(eligible, squared(pixel_re + unit) + pixel_im_2,
+                   bulb_radius_2);
+
+    const DoubleDouble512 z{_mm512_setzero_pd(), _mm512_setzero_pd()};
+    const DoubleDouble512 c_re =
+        seed.julia ? DoubleDouble512{_mm512_set1_pd(seed.re), z.lo} : pixel_re;
+    const DoubleDouble512 c_im =
+        seed.julia ? DoubleDouble512{_mm512_set1_pd(seed.im), z.lo} : pixel_im;
+    DoubleDouble512 z_re = seed.julia ? pixel_re : z;
+    DoubleDouble512 z_im = seed.julia ? pixel_im : z;
+    DoubleDouble512 check_re = z_re, check_im = z_im;
+    __mmask8 active = tail & ~interior;
+    __m512i iterations = _mm512_maskz_mov_epi64(interior, cap);
+
+    for (int iteration{}, check_at = 1; iteration < max_iteration;
+         ++iteration) {
+      const __m512d norm = _mm512_fmadd_pd(
+          z_re.hi, z_re.hi, _mm512_mul_pd(z_im.hi, z_im.hi));
+      active = _mm512_mask_cmp_pd_mask(active, norm, bailout, _CMP_LT_OQ);
+      if (active == 0) break;
+
+      iterations = _mm512_mask_add_epi64(iterations, active, iterations, one);
+
+      Formula::step(z_re, z_im, c_re, c_im);
+
+      const __m512d d_re = (z_re - check_re).hi;
+      const __m512d d_im = (z_im - check_im).hi;
+      const __mmask8 periodic = _mm512_mask_cmp_pd_mask(
+          active, _mm512_fmadd_pd(d_re, d_re, _mm512_mul_pd(d_im, d_im)),
+          tolerance_2, _CMP_LT_OQ);
+      iterations = _mm512_mask_mov_epi64(iterations, periodic, cap);
+      active &= ~periodic;
+      if (iteration + 1 == check_at) {
+        check_re = z_re, check_im = z_im;
+        check_at <<= 1;
+      }
+    }
+
+    alignas(64) std::int64_t result[8];
+    _mm512_store_si512(result, iterations);
+    for (int k{}; k < std::min(8, count - i); ++k) out[i + k] = result[k];
+  }
+}
+
+//  widest kernels the running CPU supports, picked once at startup for
+//  each formula
+struct SimdBackend {
+  EscapeKernel<double> f64;
+  EscapeKernel<float> f32;
+  EscapeKernel<DoubleDouble> dd;
+};
+
+template <typename Formula>
+inline const SimdBackend& simd_backend() {
+  static const SimdBackend backend = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return SimdBackend{escape_avx512_f64<Formula>,
+                         escape_avx512_f32<Formula>,
+                         escape_avx512_dd<Formula>};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return SimdBackend{escape_avx2_f64<Formula>, escape_avx2_f32<Formula>,
+                         escape_avx2_dd<Formula>};
+    return SimdBackend{escape_scalar<Formula, double>,
+                       escape_scalar<Formula, float>,
+                       escape_scalar<Formula, DoubleDouble>};
+  }();
+  return backend;
+}
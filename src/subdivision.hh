@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+//  rectangles this thin are iterated pixel by pixel instead of split again
+constexpr int SUBDIVISION_MIN_SIZE = 4;
+
+//  how a frame's pixels are chosen for iteration, toggled with M
+enum class RenderMode { BruteForce, Subdivision };
+
+//  escape times of the listed pixels written into the row-major frame,
+//  escape(xs, ys, count, out) evaluates any batch of pixel coordinates
+template <typename Escape>
+inline void escape_listed(const std::vector<int>& xs,
+                          const std::vector<int>& ys, const int& stride,
+                          int* frame, const Escape& escape) {
+  std::vector<int> out(xs.size());
+  escape(xs.data(), ys.data(), xs.size(), out.data());
+  for (std::size_t i{}; i < xs.size(); ++i)
+    frame[ys[i] * stride + xs[i]] = out[i];
+}
+
+//  Mariani-Silver for [x_begin, x_end) x [y_begin, y_end) whose border is
+//  already in the frame: a rectangle with a uniform border is filled with
+//  its value, any other one is cut in four by a computed middle row and
+//  column that become the border of its quarters
+//  with a distance field the filled pixels get the smallest distance on the
+//  border, a lower bound as every path to the set crosses the border
+template <typename Escape>
+inline void subdivide(const int& x_begin, const int& y_begin, const int& x_end,
+                      const int& y_end, const int& stride, int* frame,
+                      float* distance, const Escape& escape) {
+  const int x_last = x_end - 1, y_last = y_end - 1;
+  const int value = frame[y_begin * stride + x_begin];
+
+  bool uniform = true;
+  for (int x = x_begin; x < x_end && uniform; ++x)
+    uniform = frame[y_begin * stride + x] == value &&
+              frame[y_last * stride + x] == value;
+  for (int y = y_begin; y < y_end && uniform; ++y)
+    uniform = frame[y * stride + x_begin] == value &&
+              frame[y * stride + x_last] == value;
+
+  if (uniform) {
+    for (int y = y_begin + 1; y < y_last; ++y)
+      std::fill(frame + y * stride + x_begin + 1, frame + y * stride + x_last,
+                value);
+    if (distance) {
+      float nearest = distance[y_begin * stride + x_begin];
+      for (int x = x_begin; x < x_end; ++x)
+        nearest = std::min({nearest, distance[y_begin * stride + x],
+                            distance[y_last * stride + x]});
+      for (int y = y_begin; y < y_end; ++y)
+        nearest = std::min({nearest, distance[y * stride + x_begin],
+                            distance[y * stride + x_last]});
+      for (int y = y_begin + 1; y < y_last; ++y)
+        std::fill(distance + y * stride + x_begin + 1,
+                  distance + y * stride + x_last, nearest);
+    }
+    return;
+  }
+
+  std::vector<int> xs, ys;
+  if (x_end - x_begin <= SUBDIVISION_MIN_SIZE ||
+      y_end - y_begin <= SUBDIVISION_MIN_SIZE) {
+    for (int y = y_begin + 1; y < y_last; ++y)
+      for (int x = x_begin + 1; x < x_last; ++x)
+        xs.push_back(x), ys.push_back(y);
+    escape_listed(xs, ys, stride, frame, escape);
+    return;
+  }
+
+  const int x_mid = (x_begin + x_end) / 2, y_mid = (y_begin + y_end) / 2;
+  for (int x = x_begin + 1; x < x_last; ++x)
+    xs.push_back(x), ys.push_back(y_mid);
+  for (int y = y_begin + 1; y < y_last; ++y)
+    if (y != y_mid) xs.push_back(x_mid), ys.push_back(y);
+  escape_listed(xs, ys, stride, frame, escape);
+
+  subdivide(x_begin, y_begin, x_mid + 1, y_mid + 1, stride, frame, distance,
+            escape);
+  subdivide(x_mid, y_begin, x_end, y_mid + 1, stride, frame, distance,
+            escape);
+  subdivide(x_begin, y_mid, x_mid + 1, y_end, stride, frame, distance,
+            escape);
+  subdivide(x_mid, y_mid, x_end, y_end, stride, frame, distance, escape);
+}
+
+//  computes the border of a block and subdivides its inside, `distance` is
+//  null unless distances are being estimated
+template <typename Escape>
+inline void render_subdivided(const int& x_begin, const int& y_begin,
+                              const int& x_end, const int& y_end,
+                              const int& stride, int* frame, float* distance,
+                              const Escape& escape) {
+  std::vector<int> xs, ys;
+  for (int x = x_begin; x < x_end; ++x) {
+    xs.push_back(x), ys.push_back(y_begin);
+    if (y_end - 1 > y_begin) xs.push_back(x), ys.push_back(y_end - 1);
+  }
+  for (int y = y_begin + 1; y < y_end - 1; ++y) {
+    xs.push_back(x_begin), ys.push_back(y);
+    if (x_end - 1 > x_begin) xs.push_back(x_end - 1), ys.push_back(y);
+  }
+  escape_listed(xs, ys, stride, frame, escape);
+
+  subdivide(x_begin, y_begin, x_end, y_end, stride, frame, distance, escape);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//  persistent work-stealing pool
+//  every worker owns a deque of task indices, pops from its back and steals
+//  from the front of the other deques once its own runs dry, so cheap exterior
+//  tiles and expensive interior tiles even out across the cores
+class ThreadPool {
+ public:
+  explicit ThreadPool(
+      unsigned thread_count = std::thread::hardware_concurrency()) {
+    thread_count = std::max(1u, thread_count);
+    for (unsigned i{}; i < thread_count; ++i)
+      queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i{}; i < thread_count; ++i)
+      threads_.emplace_back([this, i] { worker(i); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t size() const { return threads_.size(); }
+
+  //  runs task(i) for every i in [0, count) and blocks until all of them are
+  //  done, the calling thread helps by stealing while it waits
+  void parallel_for(std::size_t count,
+                    const std::function<void(std::size_t)>& task) {
+    if (count == 0) return;
+
+    pending_.store(count);
+    task_.store(&task, std::memory_order_release);
+
+    //  interleave the indices so neighbouring tiles land on different workers
+    for (std::size_t q{}; q < queues_.size(); ++q) {
+      std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+      for (std::size_t i = q; i < count; i += queues_.size())
+        queues_[q]->items.push_back(i);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(queues_.size());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_.load() == 0; });
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::size_t> items;
+  };
+
+  //  own queue first (LIFO), then steal the oldest item of another queue
+  bool pop(std::size_t id, std::size_t& item) {
+    if (id < queues_.size()) {
+      std::lock_guard<std::mutex> lock(queues_[id]->mutex);
+      if (!queues_[id]->items.empty()) {
+        item = queues_[id]->items.back();
+        queues_[id]->items.pop_back();
+        return true;
+      }
+    }
+
+    for (std::size_t k = 1; k <= queues_.size(); ++k) {
+      auto& victim = *queues_[(id + k) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.items.empty()) {
+        item = victim.items.front();
+        victim.items.pop_front();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void drain(std::size_t id) {
+    std::size_t item;
+    while (pop(id, item)) {
+      (*task_.load(std::memory_order_acquire))(item);
+
+      if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.notify_all();
+      }
+    }
+  }
+
+  void worker(std::size_t id) {
+    std::size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+      }
+      drain(id);
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_, done_;
+  std::atomic<const std::function<void(std::size_t)>*> task_{nullptr};
+  std::atomic<std::size_t> pending_{0};
+  std::size_t generation_ = 0;
+  bool stop_ = false;
+};